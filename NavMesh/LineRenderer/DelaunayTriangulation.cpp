@@ -1,129 +1,133 @@
-
 #include "DelaunayTriangulation.h"
 #include "Triangle.h"
+#include "TriangleMesh.h"
+#include "QuadEdgeMesh.h"
+#include "ThreadPool.h"
 #include "Utility.h"
 #include "Grid.h"
 #include "TriEdge.h"
 #include "Vec2.h"
+#include "Predicates.h"
 #include <random>
 #include <algorithm>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+#include <cmath>
+#include <cfloat>
 
-std::vector<Triangle*> DelaunayTriangulate(std::vector<Vec2>& points, const std::vector<Obstacle*>& obstacles)
+TriangleMesh DelaunayTriangulate(std::vector<Vec2>& points, const std::vector<Obstacle*>& obstacles, TriangulationEngine engine, float weldDistance, const RefinementSettings& refinement)
 {
-	std::vector<Triangle*> deleteList;
-
+	// Every input point, the obstacle points follow on after the loose points
+	std::vector<Vec2> inputPoints = points;
+	std::vector<std::vector<int>> obstacleLoops;
 	for (Obstacle* ob : obstacles)
 	{
-		for (Vec2 v : ob->GetPoints())
+		std::vector<int> loop;
+		for (const Vec2& v : ob->GetPoints())
 		{
-			// Dont add any pounts we already have in the list
-			if (std::find(points.begin(), points.end(), v) == points.end())
-			{
-				points.push_back(v);
-			}
+			loop.push_back((int)inputPoints.size());
+			inputPoints.push_back(v);
 		}
+		obstacleLoops.push_back(loop);
 	}
 
-	// List of triangles we are expanding when a new triangle is created, to check for the delaunay-ness of them
-	std::vector<Triangle*> triangleStack;
+	// Dont add any points we already have, anything close enough is merged into the first point found there
+	std::vector<int> pointIds = WeldPoints(inputPoints, weldDistance, points);
 
-	// Create super triangle
-	Vec2 superTriangle[3];
-	superTriangle[0] = (Vec2{ -1000,-1000 });
-	superTriangle[1] = (Vec2{ 0,1000 });
-	superTriangle[2] = (Vec2{ 1000,-1000 });
-	triangleStack.push_back(CreateClockwiseTriangle(superTriangle));
-
-	for (int i = 0; i < points.size(); i++)
+	// Obstacle outlines refer to the welded points from here on
+	for (std::vector<int>& loop : obstacleLoops)
 	{
-		int index = -1;
-		// Find triangle that encloses the point we are checking
-		for (int j = 0; j < triangleStack.size(); j++)
+		for (int& id : loop)
 		{
-			// Search the list of triangles to see if the point is within
-			if (PointInTriangle(points[i], triangleStack[j]->mPoints[0], triangleStack[j]->mPoints[1], triangleStack[j]->mPoints[2]))
-			{
-				index = j;
-				break;
-			}
+			id = pointIds[id];
 		}
+	}
+
+	// Triangulate inside a box from 0 to 1, so the super triangle fits around every map the same way whatever its size
+	// The scale is rounded up to a power of two, so grid coordinates stay exact when divided by it
+	Vec2 boundsMin = points.empty() ? Vec2() : points[0];
+	Vec2 boundsMax = boundsMin;
+	for (const Vec2& p : points)
+	{
+		boundsMin = Vec2(std::min(boundsMin.x, p.x), std::min(boundsMin.y, p.y));
+		boundsMax = Vec2(std::max(boundsMax.x, p.x), std::max(boundsMax.y, p.y));
+	}
+
+	float size = std::max(boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y);
+	float scale = size > 0 ? std::exp2(std::ceil(std::log2(size))) : 1.0f;
 
-		// Create new triangles with the added point to the vertices of the triangle which it falls into
-		std::vector<Triangle*> potentialTriangles;
-		potentialTriangles.push_back(CreateClockwiseTriangle(std::vector<Vec2> {points[i], triangleStack[index]->mPoints[0], triangleStack[index]->mPoints[1]}));
-		potentialTriangles.push_back(CreateClockwiseTriangle(std::vector<Vec2> {points[i], triangleStack[index]->mPoints[1], triangleStack[index]->mPoints[2]}));
-		potentialTriangles.push_back(CreateClockwiseTriangle(std::vector<Vec2> {points[i], triangleStack[index]->mPoints[2], triangleStack[index]->mPoints[0]}));
+	std::vector<Vec2> normalisedPoints;
+	for (const Vec2& p : points)
+	{
+		normalisedPoints.push_back((p - boundsMin) / scale);
+	}
 
-		// Remove the triangle we just replaced (the one that contained the point we are adding)
-		deleteList.push_back(triangleStack[index]);
-		triangleStack.erase(triangleStack.begin() + index);
+	// Mesh we are expanding as each point is added, triangles know their neighbours so we only check locally for delaunay-ness
+	TriangleMesh mesh;
 
-		// Check if any newly created triangles have collinear points
-		CollinearTriangleCheck triCheck = CheckListForCollinearPoints(potentialTriangles);
+	// Create super triangle around the box, these are always the first three vertices of the mesh
+	// The further out it is the less likely it is to steal edges from the hull of the points, the predicates are exact so
+	// its size doesn't cost any precision
+	const float superSize = (float)(1 << 20);
+	mesh.AddVertex(Vec2{ 0.5f - superSize, 0.5f - superSize });
+	mesh.AddVertex(Vec2{ 0.5f, 0.5f + superSize });
+	mesh.AddVertex(Vec2{ 0.5f + superSize, 0.5f - superSize });
 
-		// Add the valid triangles to the stack
-		for (Triangle* tri : triCheck.returnTriangles)
-		{
-			ConstructTriangleEdges(tri);
-			triangleStack.push_back(tri);
-		}
+	std::vector<int> vertexIds(points.size(), -1);
 
-		// If collinear triangle is found, resolve them by creating 2 new triangles out of the collinear triangle and another triangle containing the other two vertices of the collinear triangle that isn't the newly added point
-		if (!triCheck.collinearTriangles.empty())
+	if (engine == TriangulationEngine::DIVIDE_AND_CONQUER)
+	{
+		// Triangulate the super triangle along with the points, so the result matches the incremental engine
+		for (int i = 0; i < (int)normalisedPoints.size(); i++)
 		{
-			std::vector<Triangle*> result = ResolveCollinearTriangles(triCheck.collinearTriangles, points[i], triangleStack);
-			// Add the newly fixed triangles to the stack
-			for (Triangle* tri : result)
-			{
-				if (!IsDuplicateTriangle(tri, triangleStack))
-				{
-					triangleStack.push_back(tri);
-				}
-				else
-				{
-					deleteList.push_back(tri);
-				}
-			}
+			vertexIds[i] = mesh.AddVertex(normalisedPoints[i]);
 		}
 
-		// If the stack is empty, then there is nothing left for us to check. Move on to adding the next point in the list
-		if (triangleStack.empty()) { continue; }
+		DivideAndConquerTriangulate(mesh);
+	}
+	else
+	{
+		mesh.AddTriangle(0, 1, 2);
 
-		// Check if p lies inside its circumcircle
-		for (int k = (int)triangleStack.size() - 1; k > 0; k--)
+		// Insert the points in an order where each point is close to the last one, so finding its triangle is a short walk
+		int lastTriangle = 0;
+		for (int i : GetInsertionOrder(normalisedPoints))
 		{
-			CheckCircumcircle(triangleStack[k], k, points[i], triangleStack);
+			vertexIds[i] = InsertPoint(mesh, normalisedPoints[i], lastTriangle);
+			if (vertexIds[i] != -1) { lastTriangle = mesh.GetVertexTriangle(vertexIds[i]); }
 		}
 	}
 
+	ConstrainedDelaunayTriangulation(mesh, vertexIds, obstacleLoops);
+
+	// Needs the super triangle to know where the outside is
+	RemoveTrianglesFromObstacles(mesh);
+
 	// After all points are added, remove all triangles connected with the super triangle vertices
-	std::vector<Triangle*> returnList;
-	for (int l = (int)triangleStack.size() - 1; l >= 0; l--)
+	for (int i = 0; i < mesh.GetTriangleCount(); i++)
 	{
-		if (std::find(std::begin(triangleStack[l]->mPoints), std::end(triangleStack[l]->mPoints), superTriangle[0]) == std::end(triangleStack[l]->mPoints))
+		if (mesh.IsRemoved(i)) { continue; }
+
+		if (mesh.HasVertex(i, 0) || mesh.HasVertex(i, 1) || mesh.HasVertex(i, 2))
 		{
-			if (std::find(std::begin(triangleStack[l]->mPoints), std::end(triangleStack[l]->mPoints), superTriangle[1]) == std::end(triangleStack[l]->mPoints))
-			{
-				if (std::find(std::begin(triangleStack[l]->mPoints), std::end(triangleStack[l]->mPoints), superTriangle[2]) == std::end(triangleStack[l]->mPoints))
-				{
-					returnList.push_back(triangleStack[l]);
-					continue;
-				}
-			}
+			mesh.RemoveTriangle(i);
 		}
-		deleteList.push_back(triangleStack[l]);
 	}
-	
-	returnList = ConstrainedDelaunayTriangulation(returnList, obstacles);
-	RemoveTrianglesFromObstacles(obstacles, returnList);
-	RestoreDelauneyness(returnList, points);
-	
-	for (Triangle* t : deleteList)
+
+	// Areas are given in the input units
+	RefinementSettings scaledRefinement = refinement;
+	scaledRefinement.maxArea = refinement.maxArea / (scale * scale);
+
+	RefineMesh(mesh, scaledRefinement);
+
+	// Back to the units the points were given in
+	for (int i = 0; i < mesh.GetVertexCount(); i++)
 	{
-		delete t;
+		mesh.GetVertex(i) = mesh.GetVertex(i) * scale + boundsMin;
 	}
 
-	return returnList;
+	return mesh;
 }
 
 std::vector<Vec2> PoissonDisk(Vec2 startPoint, const std::vector<Obstacle*>& obstacles)
@@ -171,737 +175,1047 @@ std::vector<Vec2> PoissonDisk(Vec2 startPoint, const std::vector<Obstacle*>& obs
 	return closedList;
 }
 
-std::vector<Triangle*> ConstrainedDelaunayTriangulation(std::vector<Triangle*>& listOfTriangles, const std::vector<Obstacle*>& obstacles)
+void ConstrainedDelaunayTriangulation(TriangleMesh& mesh, const std::vector<int>& vertexIds, const std::vector<std::vector<int>>& obstacleLoops)
 {
 	// Construct edges for all the obstacles
-	for (Obstacle* ob : obstacles)
+	for (const std::vector<int>& loop : obstacleLoops)
 	{
-		std::vector<TriEdge> constraintEdgeList;
-		for (TriEdge e : ConstructObstacleEdges(ob))
+		for (size_t i = 0; i < loop.size(); i++)
 		{
-			constraintEdgeList.push_back(e);
-		}
-		
-		for (Triangle* t : listOfTriangles)
-		{
-			ConstructTriangleEdges(t);
+			int start = vertexIds[loop[i]];
+			int end = vertexIds[loop[(i + 1) % loop.size()]];
+
+			// Points welded together leave nothing to join
+			if (start == -1 || end == -1 || start == end) { continue; }
+
+			InsertConstraintEdge(mesh, start, end);
 		}
-		HandleOverlapsWithObstacleEdges(constraintEdgeList, listOfTriangles, obstacles);
 	}
-
-	return listOfTriangles;
 }
 
-Triangle* CreateClockwiseTriangle(Vec2 points[])
+std::vector<int> WeldPoints(const std::vector<Vec2>& points, float weldDistance, std::vector<Vec2>& weldedPoints)
 {
-	Vec2 ba = points[1] - points[0];
-	Vec2 ca = points[2] - points[0];
+	weldedPoints.clear();
+	std::vector<int> pointIds(points.size(), -1);
+
+	// Points are bucketed into square cells as wide as the weld distance, so any match is in one of the 9 cells around a point
+	float cellSize = weldDistance > 0 ? weldDistance : 1.0f;
+	auto cellKey = [](long long x, long long y) { return (x << 32) ^ (y & 0xffffffff); };
+
+	// First welded point in each cell, the rest of the cell is chained through nextInCell
+	std::unordered_map<long long, int> cellHeads;
+	cellHeads.reserve(points.size());
+	std::vector<int> nextInCell;
 
-	if (PseudoCross(ba, ca) > 0)
+	for (int i = 0; i < (int)points.size(); i++)
 	{
-		Vec2 temp = points[2];
-		points[2] = points[1];
-		points[1] = temp;
-	}
+		long long cellX = (long long)std::floor(points[i].x / cellSize);
+		long long cellY = (long long)std::floor(points[i].y / cellSize);
+
+		for (long long x = cellX - 1; x <= cellX + 1 && pointIds[i] == -1; x++)
+		{
+			for (long long y = cellY - 1; y <= cellY + 1 && pointIds[i] == -1; y++)
+			{
+				auto cell = cellHeads.find(cellKey(x, y));
+				if (cell == cellHeads.end()) { continue; }
 
-	Triangle* triangle = new Triangle();
+				for (int welded = cell->second; welded != -1; welded = nextInCell[welded])
+				{
+					float dx = weldedPoints[welded].x - points[i].x;
+					float dy = weldedPoints[welded].y - points[i].y;
+					if (dx * dx + dy * dy <= weldDistance * weldDistance)
+					{
+						pointIds[i] = welded;
+						break;
+					}
+				}
+			}
+		}
 
-	triangle->mPoints[0] = points[0];
-	triangle->mPoints[1] = points[1];
-	triangle->mPoints[2] = points[2];
+		if (pointIds[i] != -1) { continue; }
 
-	return triangle;
+		// Nothing close enough, this point starts a new welded point
+		pointIds[i] = (int)weldedPoints.size();
+		weldedPoints.push_back(points[i]);
+
+		auto head = cellHeads.insert({ cellKey(cellX, cellY), -1 }).first;
+		nextInCell.push_back(head->second);
+		head->second = pointIds[i];
+	}
+
+	return pointIds;
 }
 
-Triangle* CreateClockwiseTriangle(std::vector<Vec2> points)
+int InsertPoint(TriangleMesh& mesh, const Vec2& point, int startTriangle)
 {
-	Vec2 triangle[3];
-	triangle[0] = points[0];
-	triangle[1] = points[1];
-	triangle[2] = points[2];
+	PointLocation location = LocatePoint(mesh, point, startTriangle);
 
-	return CreateClockwiseTriangle(triangle);
+	// Nothing encloses the point
+	if (location.triangle == -1) { return -1; }
+
+	// Dont add any points we already have in the mesh
+	if (location.vertex != -1) { return location.vertex; }
+
+	return InsertPointAt(mesh, location, point);
 }
 
-bool PointInTriangle(const Vec2& point, const Vec2& a, const Vec2& b, const Vec2& c)
+int InsertPointAt(TriangleMesh& mesh, const PointLocation& location, const Vec2& point)
 {
-	// Get vector for each line in triangle
-	Vec2 ab = Vec2{ b.x - a.x, b.y - a.y };
-	Vec2 bc = Vec2{ c.x - b.x, c.y - b.y };
-	Vec2 ca = Vec2{ a.x - c.x, a.y - c.y };
-
-	// Get vector for each vertex in triangle to point
-	Vec2 ap = Vec2{ point.x - a.x, point.y - a.y };
-	Vec2 bp = Vec2{ point.x - b.x, point.y - b.y };
-	Vec2 cp = Vec2{ point.x - c.x, point.y - c.y };
-
-	// Cross vectors to check
-	float one = PseudoCross(ap, ab);
-	float two = PseudoCross(bp, bc);
-	float three = PseudoCross(cp, ca);
-
-	// If all points return the same signed angle, then the point is inside the triangle
-	if ((one <= 0 && two <= 0 && three <= 0) ||
-		(one >= 0 && two >= 0 && three >= 0))
+	int vertex = mesh.AddVertex(point);
+
+	int newTriangles[4];
+	int count = 3;
+
+	// Points on an edge would make a flat triangle, so split the triangles on both sides of the edge instead
+	if (location.edge != -1)
 	{
-		return true;
+		count = mesh.SplitEdge(location.triangle, location.edge, vertex, newTriangles);
+	}
+	else
+	{
+		mesh.SplitTriangle(location.triangle, vertex, newTriangles);
 	}
 
-	return false;
+	// Only the edges facing the new point can have become non-delaunay
+	std::deque<std::pair<int, int>> flipQueue;
+	for (int i = 0; i < count; i++)
+	{
+		const MeshTriangle& tri = mesh.GetTriangle(newTriangles[i]);
+		int corner = 0;
+		while (tri.mVerts[corner] != vertex) { corner++; }
+
+		flipQueue.push_back({ tri.mVerts[(corner + 1) % 3], tri.mVerts[(corner + 2) % 3] });
+	}
+
+	RestoreDelauneyness(mesh, flipQueue);
+
+	return vertex;
 }
 
-CollinearTriangleCheck CheckListForCollinearPoints(const std::vector<Triangle*> trianglesToCheck)
+int RefineMesh(TriangleMesh& mesh, const RefinementSettings& settings)
 {
-	float threshold = 0.0001f;
+	if (settings.minAngle <= 0 && settings.maxArea <= 0) { return 0; }
 
-	CollinearTriangleCheck returnList;
-	for (int i = 0; i < trianglesToCheck.size(); i++)
+	// Refinement is only known to finish up to about 30 degrees, so higher angles always get a triangle budget
+	const float maxSafeAngle = 30.0f;
+	int maxTriangles = settings.maxTriangles;
+	if (settings.minAngle > maxSafeAngle && maxTriangles <= 0)
 	{
-		Vec2 ab = trianglesToCheck[i]->mPoints[1] - trianglesToCheck[i]->mPoints[0];
-		Vec2 ac = trianglesToCheck[i]->mPoints[2] - trianglesToCheck[i]->mPoints[0];
-		float result = PseudoCross(ab, ac);
-		if (abs(result) >= threshold || abs(result) <= threshold)
+		maxTriangles = mesh.GetLiveTriangleCount() * 16;
+	}
+
+	// A triangle's smallest angle is too small when its circumradius is too long compared to its shortest edge
+	double maxRadiusEdgeRatio = settings.minAngle > 0 ? 1.0 / (2.0 * std::sin(DegToRad(settings.minAngle))) : DBL_MAX;
+
+	// Obstacle edges and the outside of the mesh can't be crossed, points are only added along them by splitting them
+	auto isSegment = [&mesh](int triangle, int edge)
 		{
-			returnList.returnTriangles.push_back(trianglesToCheck[i]);
-		}
-		else
+			return mesh.IsConstrained(triangle, edge) || mesh.GetNeighbour(triangle, edge) == -1;
+		};
+
+	// A point encroaches on a segment when it is inside the circle the segment is the diameter of
+	auto isEncroached = [&mesh](int a, int b, const Vec2& point)
 		{
-			returnList.collinearTriangles.push_back(trianglesToCheck[i]);
+			const Vec2& start = mesh.GetVertex(a);
+			const Vec2& end = mesh.GetVertex(b);
+			return ((double)start.x - point.x) * ((double)end.x - point.x) + ((double)start.y - point.y) * ((double)end.y - point.y) < 0;
+		};
+
+	auto isBad = [&mesh, &settings, maxRadiusEdgeRatio](int triangle)
+		{
+			const Vec2& a = mesh.GetTrianglePoint(triangle, 0);
+			const Vec2& b = mesh.GetTrianglePoint(triangle, 1);
+			const Vec2& c = mesh.GetTrianglePoint(triangle, 2);
+
+			double area = std::abs(Orient2D(a, b, c)) * 0.5;
+			if (area == 0) { return false; }
+			if (settings.maxArea > 0 && area > settings.maxArea) { return true; }
+
+			double ab = std::hypot((double)b.x - a.x, (double)b.y - a.y);
+			double bc = std::hypot((double)c.x - b.x, (double)c.y - b.y);
+			double ca = std::hypot((double)a.x - c.x, (double)a.y - c.y);
+			double radius = ab * bc * ca / (4 * area);
+
+			return radius / std::min(ab, std::min(bc, ca)) > maxRadiusEdgeRatio;
+		};
+
+	std::deque<int> badTriangles;
+	std::deque<std::pair<int, int>> segments;
+
+	// Queues the triangles around a new vertex, and any segments near it that their apex now encroaches on
+	auto queueAround = [&](int vertex)
+		{
+			for (int triangle : mesh.GetTrianglesAroundVertex(vertex))
+			{
+				if (isBad(triangle)) { badTriangles.push_back(triangle); }
+
+				for (int edge = 0; edge < 3; edge++)
+				{
+					if (!isSegment(triangle, edge)) { continue; }
+
+					int a = mesh.GetTriangle(triangle).mVerts[edge];
+					int b = mesh.GetTriangle(triangle).mVerts[(edge + 1) % 3];
+					if (isEncroached(a, b, mesh.GetVertex(mesh.GetOppositeVertex(triangle, edge)))) { segments.push_back({ a, b }); }
+				}
+			}
+		};
+
+	for (int i = 0; i < mesh.GetTriangleCount(); i++)
+	{
+		if (mesh.IsRemoved(i)) { continue; }
+
+		if (isBad(i)) { badTriangles.push_back(i); }
+
+		for (int edge = 0; edge < 3; edge++)
+		{
+			if (!isSegment(i, edge)) { continue; }
+
+			int a = mesh.GetTriangle(i).mVerts[edge];
+			int b = mesh.GetTriangle(i).mVerts[(edge + 1) % 3];
+			if (isEncroached(a, b, mesh.GetVertex(mesh.GetOppositeVertex(i, edge)))) { segments.push_back({ a, b }); }
 		}
 	}
 
-	return returnList;
-}
+	int addedPoints = 0;
 
-std::vector<Triangle*> ResolveCollinearTriangles(const std::vector<Triangle*>& collinearTriangles, const Vec2& pointToFind, std::vector<Triangle*>& listToCheck)
-{
-	std::vector<Triangle*> returnTris;
-	Triangle* newTri1 = new Triangle();
-	Triangle* newTri2 = new Triangle();
-	for (Triangle* colTri : collinearTriangles)
+	// Triangles already in the current cavity hold the current stamp, so nothing has to be cleared between cavities
+	std::vector<int> cavityStamps;
+	int cavityStamp = 0;
+
+	// Adds a point halfway along a segment, returns false if it has already been split or is too short to split
+	auto splitSegment = [&](std::pair<int, int> segment)
+		{
+			MeshEdge edge = mesh.FindEdge(segment.first, segment.second);
+			if (edge.triangle == -1) { return false; }
+
+			Vec2 midPoint = (mesh.GetVertex(segment.first) + mesh.GetVertex(segment.second)) * 0.5f;
+			if (midPoint == mesh.GetVertex(segment.first) || midPoint == mesh.GetVertex(segment.second)) { return false; }
+
+			queueAround(InsertPointAt(mesh, PointLocation{ edge.triangle, edge.edge }, midPoint));
+			addedPoints++;
+			return true;
+		};
+
+	while (!segments.empty() || !badTriangles.empty())
 	{
-		for (int i = 0; i < listToCheck.size(); i++)
+		if (maxTriangles > 0 && mesh.GetLiveTriangleCount() >= maxTriangles) { break; }
+
+		// Encroached segments are split first, so triangle circumcentres never land outside of the mesh
+		if (!segments.empty())
 		{
-			if (std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), colTri->mPoints[0]) != std::end(listToCheck[i]->mPoints) && std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), colTri->mPoints[1]) != std::end(listToCheck[i]->mPoints)
-				&& std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), pointToFind) == std::end(listToCheck[i]->mPoints))
+			std::pair<int, int> segment = segments.front();
+			segments.pop_front();
+
+			splitSegment(segment);
+			continue;
+		}
+
+		int triangle = badTriangles.front();
+		badTriangles.pop_front();
+
+		if (mesh.IsRemoved(triangle) || !isBad(triangle)) { continue; }
+
+		const Vec2& a = mesh.GetTrianglePoint(triangle, 0);
+		const Vec2& b = mesh.GetTrianglePoint(triangle, 1);
+		const Vec2& c = mesh.GetTrianglePoint(triangle, 2);
+
+		double bx = (double)b.x - a.x;
+		double by = (double)b.y - a.y;
+		double cx = (double)c.x - a.x;
+		double cy = (double)c.y - a.y;
+		double d = 2 * (bx * cy - by * cx);
+		Vec2 centre = Vec2((float)(a.x + (cy * (bx * bx + by * by) - by * (cx * cx + cy * cy)) / d),
+			(float)(a.y + (bx * (cx * cx + cy * cy) - cx * (bx * bx + by * by)) / d));
+
+		// Walk towards the circumcentre, if a segment is in the way the centre is outside of the mesh so split the segment instead
+		std::vector<std::pair<int, int>> blocking;
+		int current = triangle;
+		int previous = -1;
+		while (true)
+		{
+			const MeshTriangle& tri = mesh.GetTriangle(current);
+			int crossing = -1;
+
+			int offset = rand() % 3;
+			for (int i = 0; i < 3; i++)
 			{
-				newTri1->mPoints[0] = pointToFind;
-				newTri1->mPoints[1] = colTri->mPoints[2];
-				newTri1->mPoints[2] = colTri->mPoints[0];
-				returnTris.push_back(CreateClockwiseTriangle(newTri1->mPoints));
-
-				newTri2->mPoints[0] = pointToFind;
-				newTri2->mPoints[1] = colTri->mPoints[2];
-				newTri2->mPoints[2] = colTri->mPoints[1];
-				returnTris.push_back(CreateClockwiseTriangle(newTri2->mPoints));
-
-				delete listToCheck[i];
-				listToCheck.erase(listToCheck.begin() + i);
-				break;
+				int e = (i + offset) % 3;
+				if (previous != -1 && tri.mNeighbours[e] == previous) { continue; }
+
+				if (Orient2D(mesh.GetVertex(tri.mVerts[e]), mesh.GetVertex(tri.mVerts[(e + 1) % 3]), centre) > 0)
+				{
+					crossing = e;
+					break;
+				}
 			}
 
-			if (std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), colTri->mPoints[0]) != std::end(listToCheck[i]->mPoints) && std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), colTri->mPoints[2]) != std::end(listToCheck[i]->mPoints)
-				&& std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), pointToFind) == std::end(listToCheck[i]->mPoints))
+			if (crossing == -1) { break; }
+
+			if (isSegment(current, crossing))
 			{
-				newTri1->mPoints[0] = pointToFind;
-				newTri1->mPoints[1] = listToCheck[i]->mPoints[1];
-				newTri1->mPoints[2] = listToCheck[i]->mPoints[0];
-				returnTris.push_back(CreateClockwiseTriangle(newTri1->mPoints));
-
-				newTri2->mPoints[0] = pointToFind;
-				newTri2->mPoints[1] = listToCheck[i]->mPoints[1];
-				newTri2->mPoints[2] = listToCheck[i]->mPoints[2];
-				returnTris.push_back(CreateClockwiseTriangle(newTri2->mPoints));
-
-				delete listToCheck[i];
-				listToCheck.erase(listToCheck.begin() + i);
+				blocking.push_back({ tri.mVerts[crossing], tri.mVerts[(crossing + 1) % 3] });
 				break;
 			}
 
-			if (std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), colTri->mPoints[1]) != std::end(listToCheck[i]->mPoints) && std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), colTri->mPoints[2]) != std::end(listToCheck[i]->mPoints)
-				&& std::find(std::begin(listToCheck[i]->mPoints), std::end(listToCheck[i]->mPoints), pointToFind) == std::end(listToCheck[i]->mPoints))
+			previous = current;
+			current = tri.mNeighbours[crossing];
+		}
+
+		PointLocation location;
+		if (blocking.empty())
+		{
+			location = LocatePointInTriangle(mesh, current, centre);
+
+			// Rounding put the centre on top of a vertex that is already there
+			if (location.vertex != -1 || location.triangle == -1) { continue; }
+
+			// The new point would join up with every triangle whose circumcircle holds it, any segment on those triangles that
+			// the point encroaches on has to be split instead
+			cavityStamps.resize(mesh.GetTriangleCount(), 0);
+			cavityStamp++;
+			cavityStamps[current] = cavityStamp;
+
+			std::vector<int> cavity = { current };
+			for (size_t i = 0; i < cavity.size(); i++)
 			{
-				newTri1->mPoints[0] = pointToFind;
-				newTri1->mPoints[1] = listToCheck[i]->mPoints[1];
-				newTri1->mPoints[2] = listToCheck[i]->mPoints[0];
-				returnTris.push_back(CreateClockwiseTriangle(newTri1->mPoints));
-
-				newTri2->mPoints[0] = pointToFind;
-				newTri2->mPoints[1] = listToCheck[i]->mPoints[2];
-				newTri2->mPoints[2] = listToCheck[i]->mPoints[0];
-				returnTris.push_back(CreateClockwiseTriangle(newTri2->mPoints));
-
-				delete listToCheck[i];
-				listToCheck.erase(listToCheck.begin() + i);
-				break;
+				const MeshTriangle& tri = mesh.GetTriangle(cavity[i]);
+				for (int edge = 0; edge < 3; edge++)
+				{
+					int neighbour = tri.mNeighbours[edge];
+
+					if (isSegment(cavity[i], edge))
+					{
+						if (isEncroached(tri.mVerts[edge], tri.mVerts[(edge + 1) % 3], centre)) { blocking.push_back({ tri.mVerts[edge], tri.mVerts[(edge + 1) % 3] }); }
+						continue;
+					}
+
+					if (neighbour == -1 || cavityStamps[neighbour] == cavityStamp) { continue; }
+
+					if (PointInCircumcircle(centre, mesh.GetTrianglePoint(neighbour, 0), mesh.GetTrianglePoint(neighbour, 1), mesh.GetTrianglePoint(neighbour, 2)))
+					{
+						cavityStamps[neighbour] = cavityStamp;
+						cavity.push_back(neighbour);
+					}
+				}
 			}
 		}
-	}
 
-	delete newTri1;
-	delete newTri2;
+		if (!blocking.empty())
+		{
+			bool split = false;
+			for (std::pair<int, int> segment : blocking)
+			{
+				split |= splitSegment(segment);
+			}
 
-	return returnTris;
+			// Try the triangle again once the segments are split, if none of them could be the triangle is left as it is
+			if (split) { badTriangles.push_back(triangle); }
+			continue;
+		}
+
+		queueAround(InsertPointAt(mesh, location, centre));
+		addedPoints++;
+	}
+
+	return addedPoints;
 }
 
-void ConstructTriangleEdges(Triangle* triangle)
+void DivideAndConquerTriangulate(TriangleMesh& mesh, int threadCount)
 {
-	Vec2 next;
-
-	for (size_t i = 0; i < 3; i++)
+	// Sort the vertices left to right (then bottom to top), so any run of the list sits to one side of the rest
+	std::vector<int> sorted;
+	for (int i = 0; i < mesh.GetVertexCount(); i++)
 	{
-		if (i == 3 - 1) { next = triangle->mPoints[0]; }
-		else(next = triangle->mPoints[i + 1]);
+		sorted.push_back(i);
+	}
 
-		triangle->mEdgeList[i].mPoints[0] = triangle->mPoints[i];
-		triangle->mEdgeList[i].mPoints[1] = next;
+	std::sort(sorted.begin(), sorted.end(), [&mesh](int lhs, int rhs)
+		{
+			const Vec2& a = mesh.GetVertex(lhs);
+			const Vec2& b = mesh.GetVertex(rhs);
+			if (a.x != b.x) { return a.x < b.x; }
+			return a.y < b.y;
+		});
+
+	// Points in the same place can't be triangulated
+	sorted.erase(std::unique(sorted.begin(), sorted.end(), [&mesh](int lhs, int rhs) { return mesh.GetVertex(lhs) == mesh.GetVertex(rhs); }), sorted.end());
+	if (sorted.size() < 3) { return; }
+
+	if (threadCount <= 0) { threadCount = (int)std::thread::hardware_concurrency(); }
+
+	// Split into a power of two number of strips, as long as each strip has enough points to be worth a thread
+	const int minPointsPerStrip = 1024;
+	int strips = 1;
+	while (strips * 2 <= threadCount && (int)sorted.size() / (strips * 2) >= minPointsPerStrip)
+	{
+		strips *= 2;
 	}
-}
 
-void RestoreDelauneyness(std::vector<Triangle*>& listOfTriangles, std::vector<Vec2> points)
-{
-	int safety = 0;
-	int successCount = 0;
+	std::vector<QuadEdgeMesh> edges(strips);
+	std::vector<std::pair<int, int>> hulls(strips);
 
-	while (successCount < ((listOfTriangles.size()) * (points.size())))
+	if (strips == 1)
 	{
-		safety++;
-		successCount = 0;
-		for (Vec2 p : points)
+		DivideAndConquer(edges[0], mesh, sorted, 0, (int)sorted.size());
+	}
+	else
+	{
+		ThreadPool pool(strips);
+
+		for (int i = 0; i < strips; i++)
+		{
+			int start = (int)(sorted.size() * i / strips);
+			int end = (int)(sorted.size() * (i + 1) / strips);
+			pool.Submit([&edges, &hulls, &mesh, &sorted, i, start, end]() { hulls[i] = DivideAndConquer(edges[i], mesh, sorted, start, end); });
+		}
+		pool.Wait();
+
+		// Merge neighbouring strips in pairs, each pair is independent so they can all be merged at once
+		for (int width = 1; width < strips; width *= 2)
 		{
-			for (int i = 0; i < listOfTriangles.size(); i++)
+			for (int i = 0; i < strips; i += width * 2)
 			{
-				if (CheckCircumcircle(listOfTriangles[i], i, p, listOfTriangles))
-				{
-					successCount++;
-				}
+				pool.Submit([&edges, &hulls, &mesh, i, width]()
+					{
+						int offset = edges[i].Append(edges[i + width]);
+						std::pair<int, int> right = { hulls[i + width].first + offset, hulls[i + width].second + offset };
+						hulls[i] = MergeTriangulations(edges[i], mesh, hulls[i], right);
+					});
 			}
+			pool.Wait();
 		}
-		if (safety > 100) { return; }
 	}
+
+	CopyTriangles(edges[0], mesh);
 }
 
-bool CheckCircumcircle(Triangle* triangle, int triangleIndex, const Vec2& pointToCheck, std::vector<Triangle*>& listToCheck)
+std::pair<int, int> DivideAndConquer(QuadEdgeMesh& edges, const TriangleMesh& mesh, const std::vector<int>& sorted, int start, int end)
 {
-	// Don't check any triangles that contain the point already
-	if (std::find(std::begin(triangle->mPoints), std::end(triangle->mPoints), pointToCheck) != std::end(triangle->mPoints)) { return true; }
-
-	// https://stackoverflow.com/questions/56224824/how-do-i-find-the-circumcenter-of-the-triangle-using-python-without-external-lib
-	Vec2 a = triangle->mPoints[0];
-	Vec2 b = triangle->mPoints[1];
-	Vec2 c = triangle->mPoints[2];
+	int count = end - start;
 
-	float d = 2 * ((a.x * (b.y - c.y)) + (b.x * (c.y - a.y)) + (c.x * (a.y - b.y)));
-	float x = ((((a.x * a.x) + (a.y * a.y)) * (b.y - c.y)) + ((b.x * b.x + b.y * b.y) * (c.y - a.y)) + (((c.x * c.x) + (c.y * c.y)) * (a.y - b.y))) / d;
-	float y = (((a.x * a.x + a.y * a.y) * (c.x - b.x)) + ((b.x * b.x + b.y * b.y) * (a.x - c.x)) + ((c.x * c.x + c.y * c.y) * (b.x - a.x))) / d;
-
-	Vec2 circumcenter = Vec2{ x,y };
+	if (count == 2)
+	{
+		int a = edges.MakeEdge(sorted[start], sorted[start + 1]);
+		return { a, QuadEdgeMesh::Sym(a) };
+	}
 
-	// Get lengths of each side
-	float ab = (triangle->mPoints[1] - triangle->mPoints[0]).GetMagnitude();
-	float bc = (triangle->mPoints[2] - triangle->mPoints[1]).GetMagnitude();
-	float ca = (triangle->mPoints[0] - triangle->mPoints[2]).GetMagnitude();
+	if (count == 3)
+	{
+		int a = edges.MakeEdge(sorted[start], sorted[start + 1]);
+		int b = edges.MakeEdge(sorted[start + 1], sorted[start + 2]);
+		edges.Splice(QuadEdgeMesh::Sym(a), b);
 
-	// Triangles half perimeter
-	float s = (ab + bc + ca) * 0.5f;
+		// Close the triangle, unless the points are on a line
+		double orientation = Orient2D(mesh.GetVertex(sorted[start]), mesh.GetVertex(sorted[start + 1]), mesh.GetVertex(sorted[start + 2]));
+		if (orientation > 0)
+		{
+			edges.Connect(b, a);
+			return { a, QuadEdgeMesh::Sym(b) };
+		}
+		if (orientation < 0)
+		{
+			int c = edges.Connect(b, a);
+			return { QuadEdgeMesh::Sym(c), c };
+		}
 
-	// Find area using Heron's formula
-	float area = sqrt((s * (s - ab) * (s - bc) * (s - ca)));
+		return { a, QuadEdgeMesh::Sym(b) };
+	}
 
-	// Find the radius of the circumcircle
-	float radius = (ab * bc * ca) / (4 * area);
+	int middle = start + count / 2;
+	std::pair<int, int> left = DivideAndConquer(edges, mesh, sorted, start, middle);
+	std::pair<int, int> right = DivideAndConquer(edges, mesh, sorted, middle, end);
 
-	float displacement = (pointToCheck - circumcenter).GetMagnitude();
-	if (displacement <= radius)
-	{
-		SwapTriangles(triangle, triangleIndex, pointToCheck, listToCheck);
-		return false;
-	}
-	return true;
+	return MergeTriangulations(edges, mesh, left, right);
 }
 
-void SwapTriangles(Triangle* triangleToSwap, int triangleIndex, const Vec2& point, std::vector<Triangle*>& listToCheck)
+std::pair<int, int> MergeTriangulations(QuadEdgeMesh& edges, const TriangleMesh& mesh, std::pair<int, int> left, std::pair<int, int> right)
 {
-	TriangleAndIndex adjacentTriangle = FindAdjacentTriangle(listToCheck, triangleToSwap, point);
+	int leftOuter = left.first;
+	int leftInner = left.second;
+	int rightInner = right.first;
+	int rightOuter = right.second;
+
+	auto isLeftOf = [&edges, &mesh](int vertex, int edge)
+		{
+			return Orient2D(mesh.GetVertex(vertex), mesh.GetVertex(edges.Org(edge)), mesh.GetVertex(edges.Dest(edge))) > 0;
+		};
+	auto isRightOf = [&edges, &mesh](int vertex, int edge)
+		{
+			return Orient2D(mesh.GetVertex(vertex), mesh.GetVertex(edges.Dest(edge)), mesh.GetVertex(edges.Org(edge))) > 0;
+		};
+	auto isInCircle = [&mesh](int a, int b, int c, int d)
+		{
+			return InCirclePerturbed(mesh.GetVertex(a), mesh.GetVertex(b), mesh.GetVertex(c), mesh.GetVertex(d)) > 0;
+		};
 
-	// Move on if no adjacent triangle is found
-	if (adjacentTriangle.index == -1)
+	// Walk both hulls down to the lower common tangent
+	while (true)
 	{
-		return;
+		if (isLeftOf(edges.Org(rightInner), leftInner)) { leftInner = edges.Lnext(leftInner); }
+		else if (isRightOf(edges.Org(leftInner), rightInner)) { rightInner = edges.Rprev(rightInner); }
+		else { break; }
 	}
 
-	Vec2 connectPoint = Vec2();
+	int base = edges.Connect(QuadEdgeMesh::Sym(rightInner), leftInner);
+	if (edges.Org(leftInner) == edges.Org(leftOuter)) { leftOuter = QuadEdgeMesh::Sym(base); }
+	if (edges.Org(rightInner) == edges.Org(rightOuter)) { rightOuter = base; }
+
+	// Candidates have to be above the base edge
+	auto isValid = [&edges, &isRightOf, &base](int edge) { return isRightOf(edges.Dest(edge), base); };
 
-	for (Vec2 p : triangleToSwap->mPoints)
+	// Zip the two halves together from the bottom up, removing edges that stop the new ones from being delaunay
+	while (true)
 	{
-		if (std::find(std::begin(adjacentTriangle.triangle->mPoints), std::end(adjacentTriangle.triangle->mPoints), p) == std::end(adjacentTriangle.triangle->mPoints))
+		int leftCandidate = edges.Onext(QuadEdgeMesh::Sym(base));
+		if (isValid(leftCandidate))
 		{
-			connectPoint = p;
-			break;
+			while (isInCircle(edges.Dest(base), edges.Org(base), edges.Dest(leftCandidate), edges.Dest(edges.Onext(leftCandidate))))
+			{
+				int next = edges.Onext(leftCandidate);
+				edges.DeleteEdge(leftCandidate);
+				leftCandidate = next;
+			}
 		}
-	}
 
+		int rightCandidate = edges.Oprev(base);
+		if (isValid(rightCandidate))
+		{
+			while (isInCircle(edges.Dest(base), edges.Org(base), edges.Dest(rightCandidate), edges.Dest(edges.Oprev(rightCandidate))))
+			{
+				int next = edges.Oprev(rightCandidate);
+				edges.DeleteEdge(rightCandidate);
+				rightCandidate = next;
+			}
+		}
 
-	Vec2 adjPoints[2];
-	int index = 0;
-	// Remove the point we are checking so that we aren't including it twice when we recreate the triangles below
-	for (size_t j = 0; j < 3; j++)
-	{
-		if (!Vector2IsEqual(adjacentTriangle.triangle->mPoints[j], point))
+		bool leftValid = isValid(leftCandidate);
+		bool rightValid = isValid(rightCandidate);
+
+		// Reached the upper common tangent
+		if (!leftValid && !rightValid) { break; }
+
+		if (!leftValid || (rightValid && isInCircle(edges.Dest(leftCandidate), edges.Org(leftCandidate), edges.Org(rightCandidate), edges.Dest(rightCandidate))))
 		{
-			adjPoints[index] = adjacentTriangle.triangle->mPoints[j];
-			index++;
+			base = edges.Connect(rightCandidate, QuadEdgeMesh::Sym(base));
+		}
+		else
+		{
+			base = edges.Connect(QuadEdgeMesh::Sym(base), QuadEdgeMesh::Sym(leftCandidate));
 		}
 	}
 
-	// Remove the triangles from the stack
-	// Ensure we remove the higher value first as to not ruin the indices
-	if (triangleIndex > adjacentTriangle.index)
-	{
-		delete listToCheck[triangleIndex];
-		listToCheck.erase(listToCheck.begin() + triangleIndex);
+	return { leftOuter, rightOuter };
+}
 
-		delete listToCheck[adjacentTriangle.index];
-		listToCheck.erase(listToCheck.begin() + adjacentTriangle.index);
-	}
-	else
+void CopyTriangles(const QuadEdgeMesh& edges, TriangleMesh& mesh)
+{
+	// Triangle on the left of each quarter edge, and the quarter edges around each triangle
+	std::vector<int> faces(edges.GetQuarterEdgeCount(), -1);
+	std::vector<int> triangleEdges;
+
+	// Quarters 0 and 2 are the real edges
+	for (int e = 0; e < edges.GetQuarterEdgeCount(); e += 2)
 	{
-		delete listToCheck[adjacentTriangle.index];
-		listToCheck.erase(listToCheck.begin() + adjacentTriangle.index);
+		if (edges.IsDeleted(e) || faces[e] != -1) { continue; }
 
-		delete listToCheck[triangleIndex];
-		listToCheck.erase(listToCheck.begin() + triangleIndex);
-	}
+		int e2 = edges.Lnext(e);
+		int e3 = edges.Lnext(e2);
+		if (edges.Lnext(e3) != e) { continue; }
 
-	// Add the new triangles to the stack, with the diagonal swapped
-	Triangle* triangle1 = CreateClockwiseTriangle(std::vector<Vec2>{ point, connectPoint, adjPoints[0]});
-	Triangle* triangle2 = CreateClockwiseTriangle(std::vector<Vec2>{ point, connectPoint, adjPoints[1]});
+		int a = edges.Org(e);
+		int b = edges.Org(e2);
+		int c = edges.Org(e3);
 
-	if (!IsDuplicateTriangle(triangle1, listToCheck) && !IsTriangleCollinear(triangle1))
-	{
-		listToCheck.push_back(triangle1);
-	}
-	else
-	{
-		delete triangle1;
-	}
+		// The outside of the hull also loops round, but clockwise
+		if (Orient2D(mesh.GetVertex(a), mesh.GetVertex(b), mesh.GetVertex(c)) <= 0) { continue; }
 
-	if (!IsDuplicateTriangle(triangle2, listToCheck) && !IsTriangleCollinear(triangle2))
-	{
-		listToCheck.push_back(triangle2);
+		// Faces are counter clockwise, the mesh wants them clockwise, so the mesh edges run a->c, c->b, b->a
+		int triangle = mesh.AddTriangle(a, c, b);
+		faces[e] = triangle;
+		faces[e2] = triangle;
+		faces[e3] = triangle;
+
+		triangleEdges.push_back(e3);
+		triangleEdges.push_back(e2);
+		triangleEdges.push_back(e);
 	}
-	else
+
+	for (int i = 0; i < mesh.GetTriangleCount(); i++)
 	{
-		delete triangle2;
+		for (int e = 0; e < 3; e++)
+		{
+			mesh.SetNeighbour(i, e, faces[QuadEdgeMesh::Sym(triangleEdges[i * 3 + e])]);
+		}
 	}
 }
 
-TriangleAndIndex FindAdjacentTriangle(const std::vector<Triangle*>& triangleStack, Triangle* triangle, const Vec2& pointToCheck)
+PointLocation LocatePoint(const TriangleMesh& mesh, const Vec2& point, int startTriangle)
 {
-	for (int i = 0; i < triangleStack.size(); i++)
+	int current = startTriangle;
+	int previous = -1;
+
+	// Walk from the starting triangle towards the point, crossing whichever edge has the point on its far side
+	// The orientation tests are exact, so the walk always ends at the triangle holding the point
+	while (current >= 0)
 	{
-		// Skip if the triangle we are checking is the same as the triangle we want to swap
-		if (IsSameTriangle(triangle, triangleStack[i])) { continue; }
+		if (mesh.IsRemoved(current)) { break; }
 
-		// Swaps with concave quadrilaterals do not work
-		if (!IsConvexQuadrilateral(triangleStack[i], triangle)) { continue; }
+		const MeshTriangle& tri = mesh.GetTriangle(current);
+		int next = current;
 
-		// Make sure we are returning the triangle that contains the point
-		if (std::find(std::begin(triangleStack[i]->mPoints), std::end(triangleStack[i]->mPoints), pointToCheck) != std::end(triangleStack[i]->mPoints))
+		// Start from a random edge so the walk can't get stuck going round in circles
+		int offset = rand() % 3;
+		for (int i = 0; i < 3; i++)
 		{
-			// Find the triangle that contains the two common points shared by the adjacent triangle and the point we are checking
-			if (std::find(std::begin(triangleStack[i]->mPoints), std::end(triangleStack[i]->mPoints), triangle->mPoints[0]) != std::end(triangleStack[i]->mPoints) && std::find(std::begin(triangleStack[i]->mPoints), std::end(triangleStack[i]->mPoints), triangle->mPoints[1]) != std::end(triangleStack[i]->mPoints) ||
-				std::find(std::begin(triangleStack[i]->mPoints), std::end(triangleStack[i]->mPoints), triangle->mPoints[0]) != std::end(triangleStack[i]->mPoints) && std::find(std::begin(triangleStack[i]->mPoints), std::end(triangleStack[i]->mPoints), triangle->mPoints[2]) != std::end(triangleStack[i]->mPoints) ||
-				std::find(std::begin(triangleStack[i]->mPoints), std::end(triangleStack[i]->mPoints), triangle->mPoints[1]) != std::end(triangleStack[i]->mPoints) && std::find(std::begin(triangleStack[i]->mPoints), std::end(triangleStack[i]->mPoints), triangle->mPoints[2]) != std::end(triangleStack[i]->mPoints))
+			int e = (i + offset) % 3;
+
+			// Don't test the edge we just came through
+			if (previous != -1 && tri.mNeighbours[e] == previous) { continue; }
+
+			if (Orient2D(mesh.GetVertex(tri.mVerts[e]), mesh.GetVertex(tri.mVerts[(e + 1) % 3]), point) > 0)
 			{
-				// Return the found triangle
-				return TriangleAndIndex{ i, triangleStack[i] };
+				next = tri.mNeighbours[e];
+				break;
 			}
 		}
+
+		// Nothing left to cross, this is the triangle
+		if (next == current) { return LocatePointInTriangle(mesh, current, point); }
+
+		previous = current;
+		current = next;
 	}
 
-	// Return empty struct if nothing found
-	return TriangleAndIndex{ -1, nullptr };
-}
+	// Walked off the mesh (or started nowhere), fall back to checking every triangle
+	for (int i = 0; i < mesh.GetTriangleCount(); i++)
+	{
+		if (mesh.IsRemoved(i)) { continue; }
 
-bool IsTriangleCollinear(const Triangle* triangleToCheck)
-{
-	Vec2 ab = triangleToCheck->mPoints[1] - triangleToCheck->mPoints[0];
-	Vec2 ac = triangleToCheck->mPoints[2] - triangleToCheck->mPoints[0];
+		PointLocation location = LocatePointInTriangle(mesh, i, point);
+		if (location.triangle != -1) { return location; }
+	}
 
-	return PseudoCross(ab, ac) == 0;
+	return PointLocation{};
 }
 
-bool IsDuplicateTriangle(const Triangle* triangleToCheck, const std::vector<Triangle*>& listToCheck)
+PointLocation LocatePointInTriangle(const TriangleMesh& mesh, int triangle, const Vec2& point)
 {
-	for (Triangle* triangle : listToCheck)
+	const MeshTriangle& tri = mesh.GetTriangle(triangle);
+	double sides[3];
+	for (int e = 0; e < 3; e++)
 	{
-		if (std::find(std::begin(triangle->mPoints), std::end(triangle->mPoints), triangleToCheck->mPoints[0]) != std::end(triangle->mPoints) &&
-			std::find(std::begin(triangle->mPoints), std::end(triangle->mPoints), triangleToCheck->mPoints[1]) != std::end(triangle->mPoints) &&
-			std::find(std::begin(triangle->mPoints), std::end(triangle->mPoints), triangleToCheck->mPoints[2]) != std::end(triangle->mPoints))
-		{
-			return true;
-		}
-	}
+		if (mesh.GetVertex(tri.mVerts[e]) == point) { return PointLocation{ triangle, -1, tri.mVerts[e] }; }
 
-	return false;
-}
+		// Triangles are clockwise, so anything inside sits on the negative side of every edge
+		sides[e] = Orient2D(mesh.GetVertex(tri.mVerts[e]), mesh.GetVertex(tri.mVerts[(e + 1) % 3]), point);
+		if (sides[e] > 0) { return PointLocation{}; }
+	}
 
-bool IsSameTriangle(const Triangle* tri1, const Triangle* tri2)
-{
-	if (std::find(std::begin(tri1->mPoints), std::end(tri1->mPoints), tri2->mPoints[0]) != std::end(tri1->mPoints) &&
-		std::find(std::begin(tri1->mPoints), std::end(tri1->mPoints), tri2->mPoints[1]) != std::end(tri1->mPoints) &&
-		std::find(std::begin(tri1->mPoints), std::end(tri1->mPoints), tri2->mPoints[2]) != std::end(tri1->mPoints))
+	for (int e = 0; e < 3; e++)
 	{
-		return true;
+		if (sides[e] == 0) { return PointLocation{ triangle, e, -1 }; }
 	}
 
-	return false;
+	return PointLocation{ triangle, -1, -1 };
 }
 
-bool IsConvexQuadrilateral(const Triangle* tri1, const Triangle* tri2)
+std::vector<int> GetInsertionOrder(const std::vector<Vec2>& points)
 {
-	Vec2 quad[4];
-	for (int i = 0; i < 3; i++)
-	{
-		if (std::find(std::begin(tri2->mPoints), std::end(tri2->mPoints), tri1->mPoints[i]) == std::end(tri2->mPoints))
-		{
-			quad[0] = tri1->mPoints[i];
-			break;
-		}
-	}
+	std::vector<int> order;
+	if (points.empty()) { return order; }
 
-	quad[1] = tri2->mPoints[0];
-	quad[2] = tri2->mPoints[1];
-	quad[3] = tri2->mPoints[2];
-
-	Vec2 start = quad[0];
-	for (Vec2 p : quad)
+	Vec2 min = points[0];
+	Vec2 max = points[0];
+	for (const Vec2& p : points)
 	{
-		// Assigns start to the point with the lowest y-value if their x-value is identical
-		if (p.x == start.x)
-		{
-			if (p.y < start.y) { start = p; }
-			continue;
-		}
-
-		if (p.x < start.x) { start = p; }
+		min = Vec2(std::min(min.x, p.x), std::min(min.y, p.y));
+		max = Vec2(std::max(max.x, p.x), std::max(max.y, p.y));
 	}
 
-	Vec2 next;
-	Vec2 previous = start;
-	std::vector<Vec2> list;
-	list.push_back(start);
+	float size = std::max(max.x - min.x, max.y - min.y);
+	if (size <= 0) { size = 1; }
 
-	for (int i = 0; i < 3; i++)
+	std::vector<unsigned long long> hilbert;
+	for (int i = 0; i < (int)points.size(); i++)
 	{
-		next = quad[0];
-		if (Vector2IsEqual(next, previous)) { next = quad[1]; }
-
-		for (int j = 0; j < 4; j++)
-		{
-			// We don't want to check the point we are already using
-			if (Vector2IsEqual(quad[j], next)) { continue; }
-			Vec2 ab = quad[j] - next;
-			Vec2 ac = next - previous;
+		order.push_back(i);
 
-			float result = PseudoCross(ab, ac);
-
-			// If the result is positive, then the point falls outside the line, meaning 'next' will fall inside the convex hull
-			if (result > 0) { next = quad[j]; }
-		}
-		list.push_back(next);
-		previous = next;
+		unsigned int x = (unsigned int)((points[i].x - min.x) / size * 65535.0f);
+		unsigned int y = (unsigned int)((points[i].y - min.y) / size * 65535.0f);
+		hilbert.push_back(HilbertIndex(x, y));
 	}
 
-	float result1 = FindAngle(list[0], list[1], list[3]);
-	float result2 = FindAngle(list[1], list[2], list[0]);
-	float result3 = FindAngle(list[2], list[3], list[1]);
-	float result4 = FindAngle(list[3], list[0], list[2]);
+	// Shuffle so each round is a random sample of the points, with a fixed seed so builds are repeatable
+	std::mt19937 random(1234);
+	std::shuffle(order.begin(), order.end(), random);
 
-	if (result1 < 180 && result2 < 180 && result3 < 180 && result4 < 180)
+	// Rounds double in size, within each round points are sorted along the curve so each point lands next to the last
+	for (size_t start = 0, end = 1; start < order.size(); start = end, end *= 2)
 	{
-		return true;
+		end = std::min(end, order.size());
+		std::sort(order.begin() + start, order.begin() + end, [&hilbert](int lhs, int rhs) { return hilbert[lhs] < hilbert[rhs]; });
 	}
 
-	return false;
+	return order;
 }
 
-
-std::vector<TriEdge> FindOverlapsWithConstraints(std::vector<TriEdge> constraintEdges, std::vector<Triangle*>& listOfTriangles)
+unsigned long long HilbertIndex(unsigned int x, unsigned int y)
 {
-	std::vector<TriEdge> overlappingEdges;
+	// https://en.wikipedia.org/wiki/Hilbert_curve
+	const unsigned int n = 1 << 16;
+	unsigned long long index = 0;
 
-	// Add each edge to the triangulation 
-	for (size_t i = 0; i < constraintEdges.size(); i++)
+	for (unsigned int s = n / 2; s > 0; s /= 2)
 	{
-		for (size_t j = 0; j < listOfTriangles.size(); j++)
+		unsigned int rx = (x & s) > 0;
+		unsigned int ry = (y & s) > 0;
+		index += (unsigned long long)s * s * ((3 * rx) ^ ry);
+
+		// Rotate the quadrant so the curve stays connected
+		if (ry == 0)
 		{
-			// Check if the points overlap with the edge
-			// Get the vector of the constraint edge
-			for (TriEdge tEdge : listOfTriangles[j]->mEdgeList)
+			if (rx == 1)
 			{
-				Vec2 edgePoint1 = tEdge.mPoints[0];
-				Vec2 edgePoint2 = tEdge.mPoints[1];
-
-				float result1 = PseudoCross((edgePoint2 - edgePoint1), (constraintEdges[i].mPoints[0] - edgePoint1));
-				float result2 = PseudoCross((edgePoint2 - edgePoint1), (constraintEdges[i].mPoints[1] - edgePoint1));
-
-				float result3 = PseudoCross((constraintEdges[i].mPoints[1] - constraintEdges[i].mPoints[0]), (edgePoint1 - constraintEdges[i].mPoints[0]));
-				float result4 = PseudoCross((constraintEdges[i].mPoints[1] - constraintEdges[i].mPoints[0]), (edgePoint2 - constraintEdges[i].mPoints[0]));
-
-				if (result1 * result2 < 0 && result3 * result4 < 0)
-				{
-					overlappingEdges.push_back(tEdge);
-				}
+				x = n - 1 - x;
+				y = n - 1 - y;
 			}
+			std::swap(x, y);
 		}
 	}
 
-	RemoveDuplicateEdges(overlappingEdges);
-
-	return overlappingEdges;
+	return index;
 }
 
-std::vector<TriEdge> RemoveDuplicateEdges(std::vector<TriEdge>& edges)
+void InsertConstraintEdge(TriangleMesh& mesh, int start, int end)
 {
-	std::vector<int> indices;
+	if (start == end) { return; }
 
-	for (int i = (int)edges.size() - 1; i >= 0; i--)
+	// Edge is already in the mesh, stop it from being flipped
+	MeshEdge existing = mesh.FindEdge(start, end);
+	if (existing.triangle != -1)
 	{
-		if (i >= (int)edges.size()) { i = (int)edges.size() - 1; }
+		mesh.SetConstrained(existing.triangle, existing.edge, true);
+		return;
+	}
 
-		TriEdge edge1 = edges[i];
+	Vec2 a = mesh.GetVertex(start);
+	Vec2 b = mesh.GetVertex(end);
 
-		for (int j = i - 1; j >= 0; j--)
+	// Points on the line through the constraint are on it if they are in front of the start
+	auto isAhead = [&a, &b](const Vec2& point)
 		{
-			TriEdge edge2 = edges[j];
+			if (a.x != b.x) { return (point.x > a.x) == (b.x > a.x); }
+			return (point.y > a.y) == (b.y > a.y);
+		};
+
+	// Find the triangle around the start that the constraint leaves through
+	int current = -1;
+	int left = -1;
+	int right = -1;
+	for (int triangle : mesh.GetTrianglesAroundVertex(start))
+	{
+		const MeshTriangle& tri = mesh.GetTriangle(triangle);
+		int corner = 0;
+		while (tri.mVerts[corner] != start) { corner++; }
+
+		int next = tri.mVerts[(corner + 1) % 3];
+		int previous = tri.mVerts[(corner + 2) % 3];
 
-			if ((edge1.mPoints[0] == edge2.mPoints[0] || edge1.mPoints[1] == edge2.mPoints[0]) &&
-				(edge1.mPoints[0] == edge2.mPoints[1] || edge1.mPoints[1] == edge2.mPoints[1]))
+		// If another point lies on the constraint, add each half separately
+		for (int vertex : { next, previous })
+		{
+			if (Orient2D(a, b, mesh.GetVertex(vertex)) == 0 && isAhead(mesh.GetVertex(vertex)))
 			{
-				edges.erase(edges.begin() + j);
+				InsertConstraintEdge(mesh, start, vertex);
+				InsertConstraintEdge(mesh, vertex, end);
+				return;
 			}
 		}
+
+		// Triangles are clockwise, so the constraint heads through this triangle if it is right of both edges at the start
+		if (Orient2D(a, mesh.GetVertex(next), b) < 0 && Orient2D(mesh.GetVertex(previous), a, b) < 0)
+		{
+			current = triangle;
+			left = next;
+			right = previous;
+			break;
+		}
 	}
-	return edges;
-}
 
-void HandleOverlappingEdges(std::vector<Triangle*>& listOfTriangles)
-{
-	if (listOfTriangles.size() == 0) { return; }
+	if (current == -1) { return; }
 
-	for (size_t i = 0; i < listOfTriangles.size() - 1; i++)
+	// Walk along the constraint through the triangles it crosses, storing crossed edges by vertex as flipping moves edges
+	// between triangles
+	std::deque<std::pair<int, int>> crossingEdges;
+	crossingEdges.push_back({ left, right });
+	double leftSide = Orient2D(a, b, mesh.GetVertex(left));
+
+	while (true)
 	{
-		// Construct edges for the triangle
-		for (size_t j = i + 1; j <= listOfTriangles.size() - 1; j++)
-		{
-			// Check if the points overlap with the edge
-			// Get the vector of the constraint edge
-			for (TriEdge vEdge : listOfTriangles[i]->mEdgeList)
-			{
-				for (TriEdge vEdge2 : listOfTriangles[j]->mEdgeList)
-				{
-					float result1 = PseudoCross((vEdge.mPoints[1] - vEdge.mPoints[0]), (vEdge2.mPoints[0] - vEdge.mPoints[0]));
-					float result2 = PseudoCross((vEdge.mPoints[1] - vEdge.mPoints[0]), (vEdge2.mPoints[1] - vEdge.mPoints[0]));
+		int edge = 0;
+		while (mesh.GetOppositeVertex(current, edge) == left || mesh.GetOppositeVertex(current, edge) == right) { edge++; }
 
-					float result3 = PseudoCross((vEdge2.mPoints[1] - vEdge2.mPoints[0]), (vEdge.mPoints[0] - vEdge2.mPoints[0]));
-					float result4 = PseudoCross((vEdge2.mPoints[1] - vEdge2.mPoints[0]), (vEdge.mPoints[1] - vEdge2.mPoints[0]));
+		int neighbour = mesh.GetNeighbour(current, edge);
+		int opposite = mesh.GetOppositeVertex(neighbour, mesh.GetSharedEdge(neighbour, current));
+		if (opposite == end) { break; }
 
-					bool result = (result1 * result2 < 0 && result3 * result4 < 0);
-					if (result)
-					{
-						Vec2 point{};
-						for (size_t a = 0; a < 3; a++)
-						{
-							if (std::find(std::begin(listOfTriangles[i]->mPoints), std::end(listOfTriangles[i]->mPoints), listOfTriangles[j]->mPoints[a]) == std::end(listOfTriangles[i]->mPoints))
-							{
-								point = listOfTriangles[j]->mPoints[a];
-							}
-						}
-
-						Triangle* newTriangle = CreateClockwiseTriangle(std::vector<Vec2>{vEdge.mPoints[0], vEdge.mPoints[1], point});
-
-						if (!IsDuplicateTriangle(newTriangle, listOfTriangles) && !IsTriangleCollinear(newTriangle))
-						{
-							listOfTriangles.push_back(newTriangle);
-						}
-						else
-						{
-							delete newTriangle;
-						}
-
-						delete listOfTriangles[j];
-
-						listOfTriangles.erase(listOfTriangles.begin() + j);
-					}
-				}
-			}
+		double side = Orient2D(a, b, mesh.GetVertex(opposite));
+		if (side == 0)
+		{
+			InsertConstraintEdge(mesh, start, opposite);
+			InsertConstraintEdge(mesh, opposite, end);
+			return;
 		}
-	}
-}
 
-void RemoveTrianglesFromObstacles(std::vector<Obstacle*> obstacles, std::vector<Triangle*>& listOfTriangles)
-{
-	std::vector<int> triIndexRemoval;
+		// Carry on through whichever edge still has its ends on either side of the constraint
+		if ((side < 0) == (leftSide < 0)) { left = opposite; }
+		else { right = opposite; }
 
-	for (int i = 0; i < listOfTriangles.size(); i++)
+		crossingEdges.push_back({ left, right });
+		current = neighbour;
+	}
+
+	// Swap diagonals until nothing crosses the constraint
+	std::deque<std::pair<int, int>> newEdges;
+	while (!crossingEdges.empty())
 	{
-		if (IsTriangleInObstacle(listOfTriangles[i], obstacles))
+		std::pair<int, int> crossing = crossingEdges.front();
+		crossingEdges.pop_front();
+
+		MeshEdge edge = mesh.FindEdge(crossing.first, crossing.second);
+		int neighbour = mesh.GetNeighbour(edge.triangle, edge.edge);
+
+		const MeshTriangle& tri = mesh.GetTriangle(edge.triangle);
+		int from = tri.mVerts[edge.edge];
+		int to = tri.mVerts[(edge.edge + 1) % 3];
+		int opposite = tri.mVerts[(edge.edge + 2) % 3];
+		int otherOpposite = mesh.GetOppositeVertex(neighbour, mesh.GetSharedEdge(neighbour, edge.triangle));
+
+		// Swaps with concave quadrilaterals do not work, come back to this edge once its neighbours have moved
+		if (!IsConvexQuadrilateral(mesh.GetVertex(from), mesh.GetVertex(otherOpposite), mesh.GetVertex(to), mesh.GetVertex(opposite)))
+		{
+			crossingEdges.push_back(crossing);
+			continue;
+		}
+
+		mesh.FlipEdge(edge.triangle, edge.edge);
+
+		if (DoEdgesCross(a, b, mesh.GetVertex(opposite), mesh.GetVertex(otherOpposite)))
 		{
-			triIndexRemoval.push_back(i);
+			crossingEdges.push_back({ opposite, otherOpposite });
 		}
-		else if (IsTriangleCollinear(listOfTriangles[i]))
+		else
 		{
-			triIndexRemoval.push_back(i);
+			newEdges.push_back({ opposite, otherOpposite });
 		}
 	}
 
-	// Delete them all!
-	for (int i : triIndexRemoval)
+	MeshEdge constraint = mesh.FindEdge(start, end);
+	mesh.SetConstrained(constraint.triangle, constraint.edge, true);
+
+	// Edges made while clearing the way may not be delaunay
+	RestoreDelauneyness(mesh, newEdges);
+}
+
+Triangle CreateClockwiseTriangle(Vec2 points[])
+{
+	if (Orient2D(points[0], points[1], points[2]) > 0)
 	{
-		delete listOfTriangles[i];
+		Vec2 temp = points[2];
+		points[2] = points[1];
+		points[1] = temp;
 	}
 
-	for (int i = (int)triIndexRemoval.size() - 1; i >= 0; i--)
+	Triangle triangle;
+
+	triangle.mPoints[0] = points[0];
+	triangle.mPoints[1] = points[1];
+	triangle.mPoints[2] = points[2];
+
+	return triangle;
+}
+
+Triangle CreateClockwiseTriangle(const std::vector<Vec2>& points)
+{
+	Vec2 triangle[3];
+	triangle[0] = points[0];
+	triangle[1] = points[1];
+	triangle[2] = points[2];
+
+	return CreateClockwiseTriangle(triangle);
+}
+
+bool PointInTriangle(const Vec2& point, const Vec2& a, const Vec2& b, const Vec2& c)
+{
+	// Which side of each edge the point is on
+	double one = Orient2D(a, b, point);
+	double two = Orient2D(b, c, point);
+	double three = Orient2D(c, a, point);
+
+	// If the point is on the same side of every edge, then the point is inside the triangle
+	if ((one <= 0 && two <= 0 && three <= 0) ||
+		(one >= 0 && two >= 0 && three >= 0))
 	{
-		listOfTriangles.erase(listOfTriangles.begin() + triIndexRemoval[i]);
+		return true;
 	}
+
+	return false;
 }
 
-std::vector<int> FindSharedEdgeTriangles(const TriEdge& edge, const std::vector<Triangle*>& listOfTriangles)
+void ConstructTriangleEdges(Triangle* triangle)
 {
-	std::vector<int> returnInts;
+	Vec2 next;
 
-	for (int i = 0; i < (int)listOfTriangles.size(); i++)
+	for (size_t i = 0; i < 3; i++)
 	{
-		if (std::find(std::begin(listOfTriangles[i]->mPoints), std::end(listOfTriangles[i]->mPoints), edge.mPoints[0]) != std::end(listOfTriangles[i]->mPoints) &&
-			std::find(std::begin(listOfTriangles[i]->mPoints), std::end(listOfTriangles[i]->mPoints), edge.mPoints[1]) != std::end(listOfTriangles[i]->mPoints))
-		{
-			returnInts.push_back(i);
-		}
-	}
+		if (i == 3 - 1) { next = triangle->mPoints[0]; }
+		else(next = triangle->mPoints[i + 1]);
 
-	return returnInts;
+		triangle->mEdgeList[i].mPoints[0] = triangle->mPoints[i];
+		triangle->mEdgeList[i].mPoints[1] = next;
+	}
 }
 
-void HandleOverlapsWithObstacleEdges(std::vector<TriEdge> constraintEdges, std::vector<Triangle*>& listOfTriangles, const std::vector<Obstacle*>& obstacles)
+int RestoreDelauneyness(TriangleMesh& mesh, std::deque<std::pair<int, int>>& flipQueue)
 {
-	// Add each edge to the triangulation 
-	for (size_t i = 0; i < constraintEdges.size(); i++)
+	int flips = 0;
+
+	while (!flipQueue.empty())
 	{
-		std::vector<Triangle*> overlappingTriangles;
-		for (size_t j = 0; j < listOfTriangles.size(); j++)
-		{
-			// Check if the points overlap with the edge
-			// Get the vector of the constraint edge
-			for (TriEdge tEdge : listOfTriangles[j]->mEdgeList)
-			{
-				Vec2 edgePoint1 = tEdge.mPoints[0];
-				Vec2 edgePoint2 = tEdge.mPoints[1];
+		std::pair<int, int> queued = flipQueue.front();
+		flipQueue.pop_front();
 
+		// The edge may have already been flipped away
+		MeshEdge edge = mesh.FindEdge(queued.first, queued.second);
+		if (edge.triangle == -1 || mesh.IsConstrained(edge.triangle, edge.edge)) { continue; }
 
-				if (edgePoint1 == constraintEdges[i].mPoints[0] || edgePoint1 == constraintEdges[i].mPoints[1])
-				{
-					if (edgePoint2 == constraintEdges[i].mPoints[0] || edgePoint1 == constraintEdges[i].mPoints[1])
-					{
-						continue;
-					}
-				}
+		int neighbour = mesh.GetNeighbour(edge.triangle, edge.edge);
+		if (neighbour == -1) { continue; }
 
-				float result1 = PseudoCross((edgePoint2 - edgePoint1), (constraintEdges[i].mPoints[0] - edgePoint1));
-				float result2 = PseudoCross((edgePoint2 - edgePoint1), (constraintEdges[i].mPoints[1] - edgePoint1));
+		const MeshTriangle& tri = mesh.GetTriangle(edge.triangle);
+		int a = tri.mVerts[edge.edge];
+		int b = tri.mVerts[(edge.edge + 1) % 3];
+		int c = tri.mVerts[(edge.edge + 2) % 3];
+		int d = mesh.GetOppositeVertex(neighbour, mesh.GetSharedEdge(neighbour, edge.triangle));
 
-				float result3 = PseudoCross((constraintEdges[i].mPoints[1] - constraintEdges[i].mPoints[0]), (edgePoint1 - constraintEdges[i].mPoints[0]));
-				float result4 = PseudoCross((constraintEdges[i].mPoints[1] - constraintEdges[i].mPoints[0]), (edgePoint2 - constraintEdges[i].mPoints[0]));
+		if (!PointInCircumcircle(mesh.GetVertex(d), mesh.GetVertex(a), mesh.GetVertex(b), mesh.GetVertex(c))) { continue; }
 
-				if (result1 * result2 <= 0 && result3 * result4 <= 0)
-				{
-					if (Vector2IsEqual(edgePoint1, constraintEdges[i].mPoints[0]) || Vector2IsEqual(edgePoint1, constraintEdges[i].mPoints[1]) ||
-						Vector2IsEqual(edgePoint2, constraintEdges[i].mPoints[0]) || Vector2IsEqual(edgePoint2, constraintEdges[i].mPoints[1]))
-					{
-						continue;
-					}
+		mesh.FlipEdge(edge.triangle, edge.edge);
+		flips++;
 
-					// Above results will be true for collinear lines, below cross products check to see if they are not collinear
-					float alt1 = PseudoCross(edgePoint1 - constraintEdges[i].mPoints[0], edgePoint2 - constraintEdges[i].mPoints[0]);
-					float alt2 = PseudoCross(edgePoint1 - constraintEdges[i].mPoints[1], edgePoint2 - constraintEdges[i].mPoints[1]);
+		// The outside of the quad now borders different triangles, so those edges need checking again
+		flipQueue.push_back({ c, a });
+		flipQueue.push_back({ a, d });
+		flipQueue.push_back({ d, b });
+		flipQueue.push_back({ b, c });
+	}
 
-					// If both results are 0 then the line is collinear and not crossing
-					if (alt1 == 0 && alt2 == 0) { continue; }
+	return flips;
+}
 
-					if (!IsDuplicateTriangle(listOfTriangles[j], overlappingTriangles))
-					{
-						overlappingTriangles.push_back(listOfTriangles[j]);
-						continue;
-					}
-				}
-			}
-		}
+bool PointInCircumcircle(const Vec2& point, const Vec2& a, const Vec2& b, const Vec2& c)
+{
+	// Points exactly on the circle are settled the same way every time, so the triangulation doesn't depend on the order
+	// points were added or which engine built it
+	double determinant = InCirclePerturbed(a, b, c, point);
+
+	// The sign of the determinant flips with the winding of the triangle
+	return Orient2D(a, b, c) > 0 ? determinant > 0 : determinant < 0;
+}
+
+bool IsTriangleCollinear(const Triangle* triangleToCheck)
+{
+	return Orient2D(triangleToCheck->mPoints[0], triangleToCheck->mPoints[1], triangleToCheck->mPoints[2]) == 0;
+}
 
-		if (overlappingTriangles.empty()) { continue; }
-		
-		std::vector<Vec2> a;
-		std::vector<Vec2> b;
-		Vec2 normal = (constraintEdges[i].mPoints[1] - constraintEdges[i].mPoints[0]).GetRotatedBy270().GetNormalised();
-		Vec2 midPoint = (constraintEdges[i].mPoints[1] + constraintEdges[i].mPoints[0]) * 0.5f;
-		
-		for (Vec2 v : constraintEdges[i].mPoints)
+bool IsConvexQuadrilateral(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d)
+{
+	// Every corner has to turn the same way
+	double turns[4] = { Orient2D(a, b, c), Orient2D(b, c, d), Orient2D(c, d, a), Orient2D(d, a, b) };
+
+	return (turns[0] < 0 && turns[1] < 0 && turns[2] < 0 && turns[3] < 0) ||
+		(turns[0] > 0 && turns[1] > 0 && turns[2] > 0 && turns[3] > 0);
+}
+
+bool DoEdgesCross(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d)
+{
+	// Each edge has to have one end on either side of the other, touching or collinear edges don't count
+	// Compare signs rather than multiplying, tiny results could round to 0 when multiplied
+	double result1 = Orient2D(a, b, c);
+	double result2 = Orient2D(a, b, d);
+	double result3 = Orient2D(c, d, a);
+	double result4 = Orient2D(c, d, b);
+
+	return ((result1 < 0 && result2 > 0) || (result1 > 0 && result2 < 0)) &&
+		((result3 < 0 && result4 > 0) || (result3 > 0 && result4 < 0));
+}
+
+void RemoveTrianglesFromObstacles(TriangleMesh& mesh)
+{
+	// How many obstacle edges lie between each triangle and the outside of the level, -1 until it is reached
+	std::vector<int> depth(mesh.GetTriangleCount(), -1);
+
+	// Everything touching the super triangle is outside of every obstacle
+	std::vector<int> layer;
+	for (int i = 0; i < mesh.GetTriangleCount(); i++)
+	{
+		if (mesh.IsRemoved(i)) { continue; }
+
+		if (mesh.HasVertex(i, 0) || mesh.HasVertex(i, 1) || mesh.HasVertex(i, 2))
 		{
-			a.push_back(v);
-			b.push_back(v);
+			depth[i] = 0;
+			layer.push_back(i);
 		}
-		
-		for (Triangle* t : overlappingTriangles)
+	}
+
+	// Flood each layer out across unconstrained edges, the triangles behind obstacle edges start the next layer
+	int currentDepth = 0;
+	while (!layer.empty())
+	{
+		std::vector<int> nextLayer;
+		for (size_t i = 0; i < layer.size(); i++)
 		{
-			for (Vec2 point : t->mPoints)
+			for (int edge = 0; edge < 3; edge++)
 			{
-				if (point == constraintEdges[i].mPoints[0] || point == constraintEdges[i].mPoints[1]) { continue; }
-		
-				float result = Dot(normal, (midPoint - point).Normalise());
-				if (result > 0 && std::find(a.begin(), a.end(), point) == a.end())
-				{
-					a.push_back(point);
-				}
-		
-				else if (result < 0 && std::find(b.begin(), b.end(), point) == b.end())
+				int neighbour = mesh.GetNeighbour(layer[i], edge);
+				if (neighbour == -1 || mesh.IsRemoved(neighbour) || depth[neighbour] != -1) { continue; }
+
+				if (mesh.IsConstrained(layer[i], edge))
 				{
-					b.push_back(point);
+					nextLayer.push_back(neighbour);
+					continue;
 				}
+
+				depth[neighbour] = currentDepth;
+				layer.push_back(neighbour);
 			}
-		
-			auto it = std::find(listOfTriangles.begin(), listOfTriangles.end(), t);
-			if (it != listOfTriangles.end())
-			{
-				delete listOfTriangles[it - listOfTriangles.begin()];
-				listOfTriangles.erase(it);
-			}
-		}
-		
-		std::vector<Obstacle*> obs;
-		for (Triangle* t : DelaunayTriangulate(a, obs))
-		{
-			listOfTriangles.push_back(t);
 		}
-		
-		for (Triangle* t : DelaunayTriangulate(b, obs))
+
+		currentDepth++;
+		layer.clear();
+
+		// Some of these may have been reached without crossing an obstacle edge after all
+		for (int triangle : nextLayer)
 		{
-			listOfTriangles.push_back(t);
+			if (depth[triangle] != -1) { continue; }
+
+			depth[triangle] = currentDepth;
+			layer.push_back(triangle);
 		}
 	}
-}
 
-Triangle* FindAdjacentTriangleToEdge(int currentTriangleIndex, const std::vector<Vec2>& edge, const std::vector<Triangle*>& triangleList)
-{
-	for (int i = 0; i < triangleList.size(); i++)
+	// An odd number of obstacle edges means the triangle is inside an obstacle
+	for (int i = 0; i < mesh.GetTriangleCount(); i++)
 	{
-		if (i == currentTriangleIndex) { continue; }
+		if (mesh.IsRemoved(i)) { continue; }
 
-		if (std::find(std::begin(triangleList[i]->mPoints), std::end(triangleList[i]->mPoints), edge[0]) != std::end(triangleList[i]->mPoints) && std::find(std::begin(triangleList[i]->mPoints), std::end(triangleList[i]->mPoints), edge[1]) != std::end(triangleList[i]->mPoints))
+		if (depth[i] % 2 != 0)
 		{
-			return triangleList[i];
+			mesh.RemoveTriangle(i);
+		}
+		else if (Orient2D(mesh.GetTrianglePoint(i, 0), mesh.GetTrianglePoint(i, 1), mesh.GetTrianglePoint(i, 2)) == 0)
+		{
+			mesh.RemoveTriangle(i);
 		}
 	}
-
-	return nullptr;
 }
@@ -2,88 +2,130 @@
 
 #include "Vec2.h"
 #include <vector>
+#include <deque>
 #include "Triangle.h"
+#include "NavTriangle.h"
 #include "Obstacle.h"
 
 class Grid;
+class TriangleMesh;
+class QuadEdgeMesh;
 
+// Which algorithm builds the delaunay triangulation of the points before the obstacle edges are added
+// Both give the same triangles, divide and conquer spreads the work over every core
+enum class TriangulationEngine
+{
+	INCREMENTAL,
+	DIVIDE_AND_CONQUER
+};
 
-
-struct CollinearTriangleCheck
+// Limits for the optional quality refinement after the obstacles are added, anything left at 0 is ignored
+struct RefinementSettings
 {
-	std::vector<Triangle*> returnTriangles;
-	std::vector<Triangle*> collinearTriangles;
+	// Smallest angle allowed in a triangle, in degrees. Refinement may never finish above about 30 degrees, so going that
+	// high without a triangle budget limits the mesh to 16 times the triangles it started with
+	float minAngle = 0;
+	// Largest triangle allowed, in the same units as the input points
+	float maxArea = 0;
+	// Stop adding points once the mesh has this many triangles
+	int maxTriangles = 0;
 };
 
-struct TriangleAndIndex
+// Where a point sits in the mesh
+struct PointLocation
 {
-	int index;
-	Triangle* triangle;
+	int triangle = -1;
+	// Set when the point lies on an edge of the triangle
+	int edge = -1;
+	// Set when the point is already a vertex of the mesh
+	int vertex = -1;
 };
 
 
-// If we have a random set of points
-std::vector<Triangle*> DelaunayTriangulate(std::vector<Vec2>& points, const std::vector<Obstacle*>& obstacles);
+// If we have a random set of points, returns the finished mesh with the super triangle and obstacle interiors removed
+// Points are replaced by the welded input points, obstacle points included
+// The points are moved into a unit box for triangulating, the super triangle is fitted to that box, and the mesh is moved
+// back to the input units at the end. Refinement, when turned on, runs last
+TriangleMesh DelaunayTriangulate(std::vector<Vec2>& points, const std::vector<Obstacle*>& obstacles, TriangulationEngine engine = TriangulationEngine::INCREMENTAL, float weldDistance = 0.0001f, const RefinementSettings& refinement = RefinementSettings());
 
 // Poisson Disk
 std::vector<Vec2> PoissonDisk(Vec2 startPoint, const std::vector<Obstacle*>& obstacles);
 
-// If we want constraints
-std::vector<Triangle*> ConstrainedDelaunayTriangulation(std::vector<Triangle*>& listOfTriangles, const std::vector<Obstacle*>& obstacles);
+// If we want constraints, each obstacle loop is a list of point ids that vertexIds maps to mesh vertices
+void ConstrainedDelaunayTriangulation(TriangleMesh& mesh, const std::vector<int>& vertexIds, const std::vector<std::vector<int>>& obstacleLoops);
 
-// To ensure all triangles are in the correct winding order
-Triangle* CreateClockwiseTriangle(Vec2 points[]);
-Triangle* CreateClockwiseTriangle(std::vector<Vec2> points);
+// Merges points that are within the weld distance of each other (or exactly equal when it is 0) using a hash grid
+// Fills weldedPoints with one point per group, returns which welded point each input point became
+std::vector<int> WeldPoints(const std::vector<Vec2>& points, float weldDistance, std::vector<Vec2>& weldedPoints);
 
-// Does the point fall inside the triangle
-bool PointInTriangle(const Vec2& point, const Vec2& a, const Vec2& b, const Vec2& c);
+// Adds a point to the mesh and flips edges around it until the mesh is delaunay again, returns the id of the vertex
+int InsertPoint(TriangleMesh& mesh, const Vec2& point, int startTriangle = -1);
 
-// Checks a list of points to see if they fall on the same line
-CollinearTriangleCheck CheckListForCollinearPoints(const std::vector<Triangle*> trianglesToCheck);
+// Same as InsertPoint for a point that has already been located, and isn't already in the mesh
+int InsertPointAt(TriangleMesh& mesh, const PointLocation& location, const Vec2& point);
 
-// Stops triangles from being added that are a straight line
-std::vector<Triangle*> ResolveCollinearTriangles(const std::vector<Triangle*>& collinearTriangles, const Vec2& pointToFind, std::vector<Triangle*>& listToCheck);
+// Adds points to the finished mesh until no triangle breaks the settings (Ruppert's algorithm), returns how many were added
+// Bad triangles get a point at their circumcentre, obstacle edges and the outside of the mesh are split in half when a new
+// point would come too close to them
+int RefineMesh(TriangleMesh& mesh, const RefinementSettings& settings);
 
-// Creates and assigns the edges of a triangle
-void ConstructTriangleEdges(Triangle* triangle);
+// Triangulates every vertex of a mesh that has no triangles yet using Guibas and Stolfi's divide and conquer algorithm
+// The sorted points are split into strips that are triangulated on a thread pool, then merged back together in pairs
+void DivideAndConquerTriangulate(TriangleMesh& mesh, int threadCount = 0);
 
-void RestoreDelauneyness(std::vector<Triangle*>& listOfTriangles, std::vector<Vec2> points);
+// Triangulates sorted[start, end), returns the counter clockwise hull edge leaving the leftmost vertex and the clockwise
+// hull edge leaving the rightmost vertex
+std::pair<int, int> DivideAndConquer(QuadEdgeMesh& edges, const TriangleMesh& mesh, const std::vector<int>& sorted, int start, int end);
 
-// Test if points lie in the circumcircle of a triangle
-bool CheckCircumcircle(Triangle* triangle, int triangleIndex, const Vec2& pointToCheck, std::vector<Triangle*>& listToCheck);
+// Stitches two triangulations that sit side by side into one, taking and returning hull edges as DivideAndConquer does
+std::pair<int, int> MergeTriangulations(QuadEdgeMesh& edges, const TriangleMesh& mesh, std::pair<int, int> left, std::pair<int, int> right);
 
-// Used for when a point falls within the circumcircle of a triangle
-void SwapTriangles(Triangle* triangleToSwap, int triangleIndex, const Vec2& point, std::vector<Triangle*>& listToCheck);
+// Adds the triangles of a finished quad edge triangulation to a mesh that has no triangles yet, linking up neighbours
+void CopyTriangles(const QuadEdgeMesh& edges, TriangleMesh& mesh);
 
-// Gives us the triangle which contains two of the same points
-TriangleAndIndex FindAdjacentTriangle(const std::vector<Triangle*>& triangleStack, Triangle* triangle, const Vec2& pointToCheck);
+// Finds the triangle that contains the point by walking across the mesh from the start triangle
+PointLocation LocatePoint(const TriangleMesh& mesh, const Vec2& point, int startTriangle = -1);
 
-// Checks to see if all points of the triangle fall on the same line
-bool IsTriangleCollinear(const Triangle* triangleToCheck);
+// Checks a single triangle, the returned triangle is -1 if the point is outside of it
+PointLocation LocatePointInTriangle(const TriangleMesh& mesh, int triangle, const Vec2& point);
 
-// Used for when we are adding a potential triangle to our list, to ensure we aren't doubling up
-bool IsDuplicateTriangle(const Triangle* triangleToCheck, const std::vector<Triangle*>& listToCheck);
+// Orders points so that consecutive points are close together, while still being random enough to avoid worst case insertions
+std::vector<int> GetInsertionOrder(const std::vector<Vec2>& points);
 
-// Check if two triangles are the same
-bool IsSameTriangle(const Triangle* tri1, const Triangle* tri2);
+// Distance along a hilbert curve covering a 65536 x 65536 grid
+unsigned long long HilbertIndex(unsigned int x, unsigned int y);
 
-// To ensure we are swapping the diagonals of the right triangles
-bool IsConvexQuadrilateral(const Triangle* tri1, const Triangle* tri2);
+// Forces an edge between the two vertices into the mesh by swapping any edges that cross it
+// Crossed edges are found by walking from the start vertex through the triangles along the edge
+void InsertConstraintEdge(TriangleMesh& mesh, int start, int end);
 
-// Finds all triangle edges that overlap with a constraint edge
-std::vector<TriEdge> FindOverlapsWithConstraints(std::vector<TriEdge> constraintEdges, std::vector<Triangle*>& listOfTriangles);
+// To ensure all triangles are in the correct winding order
+Triangle CreateClockwiseTriangle(Vec2 points[]);
+Triangle CreateClockwiseTriangle(const std::vector<Vec2>& points);
+
+// Does the point fall inside the triangle
+bool PointInTriangle(const Vec2& point, const Vec2& a, const Vec2& b, const Vec2& c);
+
+// Creates and assigns the edges of a triangle
+void ConstructTriangleEdges(Triangle* triangle);
 
-// Removes any edges that have been added to the list twice
-std::vector<TriEdge> RemoveDuplicateEdges(std::vector<TriEdge>& edges);
+// Flips queued edges (by vertex pair) whose opposite point falls in the circumcircle, queueing the edges around each flip
+// until the queue is empty. Returns how many flips were made
+int RestoreDelauneyness(TriangleMesh& mesh, std::deque<std::pair<int, int>>& flipQueue);
 
-// Cycles through the overlapping edge list and will swap triangles that share the same edge
-void HandleOverlappingEdges(std::vector<Triangle*>& listOfTriangles);
+// Test if points lie in the circumcircle of a triangle
+bool PointInCircumcircle(const Vec2& point, const Vec2& a, const Vec2& b, const Vec2& c);
 
-// Removes any triangles that are inside of the obstacles
-void RemoveTrianglesFromObstacles(std::vector<Obstacle*> obstacles, std::vector<Triangle*>& listOfTriangles);
+// Checks to see if all points of the triangle fall on the same line
+bool IsTriangleCollinear(const Triangle* triangleToCheck);
 
-std::vector<int> FindSharedEdgeTriangles(const TriEdge& edge, const std::vector<Triangle*>& listOfTriangles);
+// To ensure we are swapping the diagonals of the right triangles, points are given in order around the quad
+bool IsConvexQuadrilateral(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d);
 
-void HandleOverlapsWithObstacleEdges(std::vector<TriEdge>, std::vector<Triangle*>& listOfTriangles, const std::vector<Obstacle*>& obstacles);
+// Do the edges a->b and c->d cross each other
+bool DoEdgesCross(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d);
 
-Triangle* FindAdjacentTriangleToEdge(int currentTriangleIndex, const std::vector<Vec2>& edge, const std::vector<Triangle*>& triangleList);
\ No newline at end of file
+// Removes any triangles that are inside of the obstacles, along with any flat triangles
+// Floods out from the super triangle across the mesh, counting the obstacle edges crossed to reach each triangle, so it
+// has to be called before the super triangle is removed
+void RemoveTrianglesFromObstacles(TriangleMesh& mesh);
@@ -0,0 +1,94 @@
+#include "FlowField.h"
+
+#include "NodeGraph.h"
+#include "NavigationMesh.h"
+#include "LineRenderer.h"
+#include "NavigationUtilities.h"
+#include <cfloat>
+#include <cmath>
+
+FlowField::FlowField(const NodeGraph* graph) : mGraph(graph)
+{
+}
+
+void FlowField::Build(const Vec2& goal)
+{
+	int nodeCount = mGraph->GetNodeCount();
+	mCosts.assign(nodeCount, FLT_MAX);
+	mNextNodes.assign(nodeCount, -1);
+	mNextEdges.assign(nodeCount, -1);
+
+	mGoalNode = mGraph->GetClosestNode(goal);
+	if (mGoalNode == -1) { return; }
+
+	// A goal off the mesh is swapped for the middle of the closest node
+	mGoal = mGraph->GetNavMesh()->PolygonContainsPoint(mGoalNode, goal) ? goal : mGraph->GetPosition(mGoalNode);
+
+	// Connections cost the same both ways, so searching out from the goal gives the cost of getting back to it
+	mSearch.Reset(nodeCount);
+	mSearch.Open(mGoalNode, 0, 0, -1);
+	while (!mSearch.IsOpenEmpty())
+	{
+		int currentNode = mSearch.PopLowest();
+		float currentScore = mSearch.GetGScore(currentNode);
+		mCosts[currentNode] = currentScore;
+
+		int previous = mSearch.GetPrevious(currentNode);
+		if (previous != -1)
+		{
+			mNextNodes[currentNode] = previous;
+			mNextEdges[currentNode] = mGraph->FindEdge(currentNode, previous);
+		}
+
+		for (int edge = mGraph->GetEdgeStart(currentNode); edge < mGraph->GetEdgeEnd(currentNode); edge++)
+		{
+			int target = mGraph->GetEdgeTarget(edge);
+			if (mSearch.IsClosed(target)) { continue; }
+
+			float gScore = currentScore + mGraph->GetEdgeCost(edge);
+			mSearch.Open(target, gScore, gScore, currentNode);
+		}
+	}
+}
+
+Vec2 FlowField::GetSteeringTarget(int node, const Vec2& position, float radius) const
+{
+	int edge = mNextEdges[node];
+	if (edge == -1) { return node == mGoalNode ? mGoal : position; }
+
+	// Pull the ends of the portal in as string pulling does, narrow portals are crossed in the middle
+	float clearance = GetPortalClearance(radius);
+	Vec2 start = mGraph->GetPortalStart(edge);
+	Vec2 end = mGraph->GetPortalEnd(edge);
+	Vec2 portal = end - start;
+	float length = portal.GetMagnitude();
+	if (length <= clearance * 2) { return (start + end) * 0.5f; }
+
+	portal /= length;
+	start += portal * clearance;
+	end -= portal * clearance;
+
+	// Cross where the straight line to the goal does, or as close to it as the portal goes
+	Vec2 toGoal = mGoal - position;
+	float startSide = PseudoCross(toGoal, start - position);
+	float endSide = PseudoCross(toGoal, end - position);
+	if ((startSide <= 0) != (endSide <= 0))
+	{
+		return start + (end - start) * (startSide / (startSide - endSide));
+	}
+
+	return fabsf(startSide) < fabsf(endSide) ? start : end;
+}
+
+void FlowField::Draw(LineRenderer* lines) const
+{
+	if (!IsBuilt()) { return; }
+
+	for (int node = 0; node < (int)mNextNodes.size(); node++)
+	{
+		if (mNextNodes[node] == -1) { continue; }
+		lines->DrawLineWithArrow(mGraph->GetPosition(node), mGraph->GetPosition(mNextNodes[node]), Colour::GREEN, 100);
+	}
+
+	lines->DrawCircle(mGoal, 50, Colour::GREEN);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Vec2.h"
+#include "SearchContext.h"
+#include <vector>
+
+class NodeGraph;
+class LineRenderer;
+
+// Every node's next step towards one goal, from a single Dijkstra search outwards from the goal
+// Any number of agents heading for the same place can follow it, each step only looks at the agent's own node
+// Nodes are convex, so an agent heading straight for the edge into the next node never leaves the node it is in
+class FlowField
+{
+	const NodeGraph* mGraph;
+
+	Vec2 mGoal;
+	int mGoalNode = -1;
+
+	// Cost of getting to the goal from each node, FLT_MAX if it can't be reached
+	std::vector<float> mCosts;
+	// The node to move into next and the connection to it, -1 at the goal and wherever the goal can't be reached
+	std::vector<int> mNextNodes;
+	std::vector<int> mNextEdges;
+
+	SearchContext mSearch;
+
+public:
+	FlowField(const NodeGraph* graph);
+
+	// Works out the field for a new goal, replacing the old one
+	void Build(const Vec2& goal);
+
+	const Vec2& GetGoal() const { return mGoal; }
+	int GetGoalNode() const { return mGoalNode; }
+	bool IsBuilt() const { return mGoalNode != -1; }
+
+	float GetCost(int node) const { return mCosts[node]; }
+	int GetNextNode(int node) const { return mNextNodes[node]; }
+	bool IsReachable(int node) const { return node == mGoalNode || mNextNodes[node] != -1; }
+
+	// Where to head for from a position in the node. A point on the edge into the next node, kept the portal clearance away
+	// from its ends, and as close to the straight line to the goal as the edge allows. The goal itself in the goal node
+	Vec2 GetSteeringTarget(int node, const Vec2& position, float radius) const;
+
+	void Draw(LineRenderer* lines) const;
+};
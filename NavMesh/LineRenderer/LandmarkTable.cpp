@@ -0,0 +1,216 @@
+#include "LandmarkTable.h"
+
+#include "NodeGraph.h"
+#include "SearchContext.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Start of every saved table, along with the format version
+static const char LANDMARK_FILE_ID[4] = { 'L', 'M', 'R', 'K' };
+static const int LANDMARK_FILE_VERSION = 2;
+
+void LandmarkTable::Build(const NodeGraph& graph, int landmarkCount)
+{
+	Clear();
+
+	int nodeCount = graph.GetNodeCount();
+	landmarkCount = std::min(landmarkCount, nodeCount);
+	if (landmarkCount <= 0) { return; }
+
+	mNodeCount = nodeCount;
+	mEdgeCount = graph.GetEdgeStart(nodeCount);
+	mChecksum = ComputeChecksum(graph);
+	mDistances.resize((size_t)nodeCount * landmarkCount);
+
+	// Closest landmark to each node so far, the next landmark is the node where this is largest
+	// Nodes no landmark reaches stay at FLT_MAX, so every separate part of the mesh ends up with a landmark
+	std::vector<float> closest(nodeCount, FLT_MAX);
+	std::vector<float> costs;
+
+	// Starting from whatever is furthest from node 0 puts the first landmark out at the edge of the mesh
+	FindAllCosts(graph, 0, costs);
+	int landmark = (int)(std::max_element(costs.begin(), costs.end(), [](float a, float b)
+	{
+		return (a == FLT_MAX ? -1 : a) < (b == FLT_MAX ? -1 : b);
+	}) - costs.begin());
+
+	for (int i = 0; i < landmarkCount; i++)
+	{
+		mLandmarks.push_back(landmark);
+		FindAllCosts(graph, landmark, costs);
+
+		for (int node = 0; node < nodeCount; node++)
+		{
+			mDistances[(size_t)node * landmarkCount + i] = costs[node];
+			closest[node] = std::min(closest[node], costs[node]);
+		}
+
+		landmark = (int)(std::max_element(closest.begin(), closest.end()) - closest.begin());
+	}
+}
+
+void LandmarkTable::Clear()
+{
+	mNodeCount = 0;
+	mEdgeCount = 0;
+	mChecksum = 0;
+	mLandmarks.clear();
+	mDistances.clear();
+}
+
+float LandmarkTable::EstimateCost(int from, int to) const
+{
+	int landmarkCount = (int)mLandmarks.size();
+	const float* fromDistances = mDistances.data() + (size_t)from * landmarkCount;
+	const float* toDistances = mDistances.data() + (size_t)to * landmarkCount;
+
+	float estimate = 0;
+	for (int i = 0; i < landmarkCount; i++)
+	{
+		// Only landmarks that reach both nodes say anything
+		if (fromDistances[i] == FLT_MAX || toDistances[i] == FLT_MAX) { continue; }
+		estimate = std::max(estimate, fabsf(fromDistances[i] - toDistances[i]));
+	}
+
+	return estimate;
+}
+
+bool LandmarkTable::Save(const std::string& filename) const
+{
+	std::ofstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Error saving landmarks: " << filename << std::endl;
+		return false;
+	}
+
+	int landmarkCount = (int)mLandmarks.size();
+	file.write(LANDMARK_FILE_ID, sizeof(LANDMARK_FILE_ID));
+	file.write((const char*)&LANDMARK_FILE_VERSION, sizeof(int));
+	file.write((const char*)&mNodeCount, sizeof(int));
+	file.write((const char*)&mEdgeCount, sizeof(int));
+	file.write((const char*)&mChecksum, sizeof(unsigned int));
+	file.write((const char*)&landmarkCount, sizeof(int));
+	file.write((const char*)mLandmarks.data(), sizeof(int) * mLandmarks.size());
+	file.write((const char*)mDistances.data(), sizeof(float) * mDistances.size());
+
+	return file.good();
+}
+
+bool LandmarkTable::Load(const std::string& filename, const NodeGraph& graph)
+{
+	Clear();
+
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Error loading landmarks: " << filename << std::endl;
+		return false;
+	}
+
+	char id[sizeof(LANDMARK_FILE_ID)];
+	int version = 0;
+	int nodeCount = 0;
+	int edgeCount = 0;
+	unsigned int checksum = 0;
+	int landmarkCount = 0;
+	file.read(id, sizeof(id));
+	file.read((char*)&version, sizeof(int));
+	file.read((char*)&nodeCount, sizeof(int));
+	file.read((char*)&edgeCount, sizeof(int));
+	file.read((char*)&checksum, sizeof(unsigned int));
+	file.read((char*)&landmarkCount, sizeof(int));
+
+	// A table for another graph would overestimate, which stops A* finding the shortest path
+	if (!file || memcmp(id, LANDMARK_FILE_ID, sizeof(id)) != 0 || version != LANDMARK_FILE_VERSION ||
+		nodeCount != graph.GetNodeCount() || edgeCount != graph.GetEdgeStart(nodeCount) || checksum != ComputeChecksum(graph) || landmarkCount <= 0 ||
+		landmarkCount > nodeCount)
+	{
+		std::cout << "Landmarks in " << filename << " don't match the node graph\n";
+		return false;
+	}
+
+	mLandmarks.resize(landmarkCount);
+	mDistances.resize((size_t)nodeCount * landmarkCount);
+	file.read((char*)mLandmarks.data(), sizeof(int) * mLandmarks.size());
+	file.read((char*)mDistances.data(), sizeof(float) * mDistances.size());
+
+	if (!file)
+	{
+		std::cout << "Landmarks in " << filename << " are cut short\n";
+		Clear();
+		return false;
+	}
+
+	for (int landmark : mLandmarks)
+	{
+		if (landmark < 0 || landmark >= nodeCount)
+		{
+			std::cout << "Landmarks in " << filename << " refer to node " << landmark << " outside the node graph\n";
+			Clear();
+			return false;
+		}
+	}
+
+	mNodeCount = nodeCount;
+	mEdgeCount = edgeCount;
+	mChecksum = checksum;
+	return true;
+}
+
+void LandmarkTable::FindAllCosts(const NodeGraph& graph, int startNode, std::vector<float>& costs)
+{
+	int nodeCount = graph.GetNodeCount();
+	costs.assign(nodeCount, FLT_MAX);
+
+	SearchContext context;
+	context.Reset(nodeCount);
+	context.Open(startNode, 0, 0, -1);
+	while (!context.IsOpenEmpty())
+	{
+		int currentNode = context.PopLowest();
+		float currentScore = context.GetGScore(currentNode);
+		costs[currentNode] = currentScore;
+
+		for (int edge = graph.GetEdgeStart(currentNode); edge < graph.GetEdgeEnd(currentNode); edge++)
+		{
+			int target = graph.GetEdgeTarget(edge);
+			if (context.IsClosed(target)) { continue; }
+
+			float gScore = currentScore + graph.GetEdgeCost(edge);
+			context.Open(target, gScore, gScore, currentNode);
+		}
+	}
+}
+
+unsigned int LandmarkTable::ComputeChecksum(const NodeGraph& graph)
+{
+	unsigned int hash = 2166136261u;
+	auto add = [&hash](const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+	};
+
+	for (int node = 0; node < graph.GetNodeCount(); node++)
+	{
+		int edgeEnd = graph.GetEdgeEnd(node);
+		add(&edgeEnd, sizeof(int));
+		for (int edge = graph.GetEdgeStart(node); edge < edgeEnd; edge++)
+		{
+			int target = graph.GetEdgeTarget(edge);
+			float cost = graph.GetEdgeCost(edge);
+			add(&target, sizeof(int));
+			add(&cost, sizeof(float));
+		}
+	}
+
+	return hash;
+}
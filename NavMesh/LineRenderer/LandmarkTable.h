@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class NodeGraph;
+
+// Graph distances from a few landmark nodes to every node, worked out once after the graph is built
+// By the triangle inequality the cost between two nodes is at least the difference in their distances to any landmark,
+// which gives A* a much better estimate than a straight line when walls are in the way (the ALT heuristic)
+class LandmarkTable
+{
+	int mNodeCount = 0;
+	int mEdgeCount = 0;
+	// Hash of the connections and costs of the graph the table was built for
+	unsigned int mChecksum = 0;
+	std::vector<int> mLandmarks;
+	// mDistances[node * landmark count + landmark], so the distances for one node sit together. FLT_MAX where a landmark
+	// can't reach the node
+	std::vector<float> mDistances;
+
+public:
+	// Landmarks are picked one at a time, each the node furthest from all of the landmarks picked so far
+	void Build(const NodeGraph& graph, int landmarkCount);
+	void Clear();
+
+	bool IsBuilt() const { return !mLandmarks.empty(); }
+	int GetLandmarkCount() const { return (int)mLandmarks.size(); }
+	int GetLandmark(int landmark) const { return mLandmarks[landmark]; }
+	float GetDistance(int landmark, int node) const { return mDistances[node * mLandmarks.size() + landmark]; }
+
+	// Never more than the real cost between the nodes, 0 if the table isn't built
+	float EstimateCost(int from, int to) const;
+
+	// Written next to the mesh so the table doesn't have to be worked out on every load. Loading fails if the table was
+	// made for a different graph
+	bool Save(const std::string& filename) const;
+	bool Load(const std::string& filename, const NodeGraph& graph);
+
+private:
+	// Dijkstra over the whole graph, FLT_MAX for nodes that can't be reached
+	static void FindAllCosts(const NodeGraph& graph, int startNode, std::vector<float>& costs);
+	// FNV-1a over the edge rows, targets and costs, so a table can't be loaded for a different graph of the same size
+	static unsigned int ComputeChecksum(const NodeGraph& graph);
+};
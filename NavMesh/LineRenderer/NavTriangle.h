@@ -0,0 +1,14 @@
+#pragma once
+
+// Corners of a navigation mesh triangle as indices into the mesh's vertex array, in clockwise order
+// Edge i runs from mVerts[i] to mVerts[(i + 1) % 3]
+struct NavTriangle
+{
+	int mVerts[3];
+};
+
+// The triangle on the other side of each edge of a navigation mesh triangle, -1 along the edge of the mesh
+struct NavNeighbours
+{
+	int mTriangles[3];
+};
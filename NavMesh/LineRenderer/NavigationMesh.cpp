@@ -1,8 +1,9 @@
 #include "NavigationMesh.h"
-#include "Triangle.h"
 #include "DelaunayTriangulation.h"
+#include "TriangleMesh.h"
 #include "Obstacle.h"
 #include "TextStream.h"
+#include "Predicates.h"
 
 NavigationMesh::NavigationMesh()
 {
@@ -10,10 +11,6 @@ NavigationMesh::NavigationMesh()
 
 NavigationMesh::~NavigationMesh()
 {
-	for (Triangle* t : mTriangles)
-	{
-		delete t;
-	}
 }
 
 void NavigationMesh::Draw(LineRenderer* lines)
@@ -23,19 +20,16 @@ void NavigationMesh::Draw(LineRenderer* lines)
 		lines->DrawCircle(mPoints[i], 0.1f, Colour::GREEN);
 	}
 
-	int index = 0;
-	for (Triangle* t : mTriangles)
+	for (int i = 0; i < GetNumberOfPolygons(); i++)
 	{
-		lines->AddPointToLine(t->mPoints[0], Colour::WHITE);
-		lines->AddPointToLine(t->mPoints[1], Colour::WHITE);
-		lines->AddPointToLine(t->mPoints[2], Colour::WHITE);
+		for (int corner = 0; corner < GetPolygonSize(i); corner++)
+		{
+			lines->AddPointToLine(GetPolygonPoint(i, corner), Colour::WHITE);
+		}
 		lines->FinishLineLoop();
 	
-		//Vec2 result = t->mPoints[0] + t->mPoints[1] + t->mPoints[2];
-		//result /= 3;
-		//TextStream output(lines, Vec2(result.x, result.y), 150.0f, Colour::YELLOW);
-		//output << index;
-		//index++;
+		//TextStream output(lines, GetPolygonCentre(i), 150.0f, Colour::YELLOW);
+		//output << i;
 	}
 
 	for (Vec2 v : mPoints)
@@ -47,7 +41,152 @@ void NavigationMesh::Draw(LineRenderer* lines)
 
 void NavigationMesh::Build(std::vector<Obstacle*>& obstacles)
 {
-	mTriangles = DelaunayTriangulate(mPoints, obstacles);
+	TriangleMesh mesh = DelaunayTriangulate(mPoints, obstacles, mEngine, mWeldDistance, mRefinement);
+
+	// Only the finished triangles are kept, the working mesh is thrown away
+	std::vector<bool> constrainedEdges;
+	mesh.CreateNavigationArrays(mVertices, mTriangles, mNeighbours, constrainedEdges);
+	mFlipCount = mesh.GetFlipCount();
+
+	MergePolygons(constrainedEdges);
+
+	mVersion++;
+}
+
+void NavigationMesh::MergePolygons(const std::vector<bool>& constrainedEdges)
+{
+	// A corner of a polygon along with the edge leaving it
+	struct Corner
+	{
+		int vertex;
+		// Triangle on the other side of the edge
+		int neighbour;
+	};
+
+	int triangleCount = (int)mTriangles.size();
+
+	// Every triangle starts off as its own polygon
+	std::vector<std::vector<Corner>> polygons(triangleCount);
+	std::vector<std::vector<int>> polygonTriangles(triangleCount);
+	mTrianglePolygons.resize(triangleCount);
+
+	for (int i = 0; i < triangleCount; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			polygons[i].push_back({ mTriangles[i].mVerts[j], mNeighbours[i].mTriangles[j] });
+		}
+		polygonTriangles[i].push_back(i);
+		mTrianglePolygons[i] = i;
+	}
+
+	// Finds the corner in a polygon that starts the edge from the vertex to the given triangle
+	auto findCorner = [](const std::vector<Corner>& corners, int vertex, int neighbour)
+	{
+		for (int j = 0; j < (int)corners.size(); j++)
+		{
+			if (corners[j].vertex == vertex && corners[j].neighbour == neighbour) { return j; }
+		}
+		return -1;
+	};
+
+	for (int i = 0; mMergePolygons && i < triangleCount; i++)
+	{
+		for (int edge = 0; edge < 3; edge++)
+		{
+			// Each edge is only looked at from the lower numbered triangle, the outside and obstacle edges are kept
+			int neighbour = mNeighbours[i].mTriangles[edge];
+			if (neighbour < i || constrainedEdges[i * 3 + edge]) { continue; }
+
+			int firstPolygon = mTrianglePolygons[i];
+			int secondPolygon = mTrianglePolygons[neighbour];
+			if (firstPolygon == secondPolygon) { continue; }
+
+			std::vector<Corner>& first = polygons[firstPolygon];
+			std::vector<Corner>& second = polygons[secondPolygon];
+			int firstCount = (int)first.size();
+			int secondCount = (int)second.size();
+
+			// The edge runs a->b in the first polygon and b->a in the second
+			int a = mTriangles[i].mVerts[edge];
+			int b = mTriangles[i].mVerts[(edge + 1) % 3];
+			int firstA = findCorner(first, a, neighbour);
+			int secondB = findCorner(second, b, i);
+
+			// Without the edge, a sits between the corner before it in the first polygon and the corner after it in the
+			// second, and b the other way round. Both have to still turn clockwise (or go straight on)
+			const Vec2& beforeA = mVertices[first[(firstA + firstCount - 1) % firstCount].vertex];
+			const Vec2& afterA = mVertices[second[(secondB + 2) % secondCount].vertex];
+			const Vec2& beforeB = mVertices[second[(secondB + secondCount - 1) % secondCount].vertex];
+			const Vec2& afterB = mVertices[first[(firstA + 2) % firstCount].vertex];
+
+			if (Orient2D(beforeA, mVertices[a], afterA) > 0 || Orient2D(beforeB, mVertices[b], afterB) > 0) { continue; }
+
+			// Walk the first polygon from b round to a, then the second from a round to the corner before b
+			std::vector<Corner> merged;
+			merged.reserve(firstCount + secondCount - 2);
+			for (int j = 1; j < firstCount; j++)
+			{
+				merged.push_back(first[(firstA + j) % firstCount]);
+			}
+			for (int j = 1; j < secondCount; j++)
+			{
+				merged.push_back(second[(secondB + j) % secondCount]);
+			}
+
+			first = std::move(merged);
+			second.clear();
+
+			for (int triangle : polygonTriangles[secondPolygon])
+			{
+				mTrianglePolygons[triangle] = firstPolygon;
+				polygonTriangles[firstPolygon].push_back(triangle);
+			}
+			polygonTriangles[secondPolygon].clear();
+		}
+	}
+
+	// Pack the polygons that are left, edges point at polygons rather than triangles from here on
+	std::vector<int> polygonIndices(triangleCount, -1);
+	mPolygonStarts.clear();
+	mPolygonVerts.clear();
+	mPolygonNeighbours.clear();
+
+	for (int i = 0; i < triangleCount; i++)
+	{
+		if (polygons[i].empty()) { continue; }
+
+		polygonIndices[i] = (int)mPolygonStarts.size();
+		mPolygonStarts.push_back((int)mPolygonVerts.size());
+		for (const Corner& corner : polygons[i])
+		{
+			mPolygonVerts.push_back(corner.vertex);
+		}
+	}
+	mPolygonStarts.push_back((int)mPolygonVerts.size());
+
+	for (int i = 0; i < triangleCount; i++)
+	{
+		for (const Corner& corner : polygons[i])
+		{
+			mPolygonNeighbours.push_back(corner.neighbour == -1 ? -1 : polygonIndices[mTrianglePolygons[corner.neighbour]]);
+		}
+	}
+
+	for (int& polygon : mTrianglePolygons)
+	{
+		polygon = polygonIndices[polygon];
+	}
+}
+
+Vec2 NavigationMesh::GetTriangleCentre(int triangle) const
+{
+	// Average the points location
+	const Vec2& a = GetTrianglePoint(triangle, 0);
+	const Vec2& b = GetTrianglePoint(triangle, 1);
+	const Vec2& c = GetTrianglePoint(triangle, 2);
+
+	return Vec2{ (a.x + b.x + c.x) / 3, (a.y + b.y + c.y) / 3 };
 }
 
 void NavigationMesh::AddPointList(std::vector<Vec2> pointList)
@@ -57,3 +196,62 @@ void NavigationMesh::AddPointList(std::vector<Vec2> pointList)
 		AddPoint(p);
 	}
 }
+
+Vec2 NavigationMesh::GetPolygonCentre(int polygon) const
+{
+	// Fan out from the first corner, weighting the centre of each triangle by its area
+	const Vec2& origin = GetPolygonPoint(polygon, 0);
+	Vec2 centre;
+	float area = 0;
+
+	for (int corner = 1; corner < GetPolygonSize(polygon) - 1; corner++)
+	{
+		const Vec2& b = GetPolygonPoint(polygon, corner);
+		const Vec2& c = GetPolygonPoint(polygon, corner + 1);
+
+		float triangleArea = PseudoCross(b - origin, c - origin);
+		centre += (origin + b + c) * triangleArea;
+		area += triangleArea;
+	}
+
+	if (area == 0)
+	{
+		// Flat polygon, fall back to the average of the corners
+		for (int corner = 1; corner < GetPolygonSize(polygon); corner++)
+		{
+			centre += GetPolygonPoint(polygon, corner);
+		}
+		return (centre + origin) / (float)GetPolygonSize(polygon);
+	}
+
+	return centre / (area * 3);
+}
+
+bool NavigationMesh::PolygonContainsPoint(int polygon, const Vec2& point) const
+{
+	// The vertices can be moved after building (the world flips the y axis), which turns clockwise polygons counter
+	// clockwise, so the point is inside as long as it is never on both sides of the edges
+	bool left = false;
+	bool right = false;
+	int size = GetPolygonSize(polygon);
+	for (int corner = 0; corner < size; corner++)
+	{
+		double side = Orient2D(GetPolygonPoint(polygon, corner), GetPolygonPoint(polygon, (corner + 1) % size), point);
+		if (side > 0) { left = true; }
+		else if (side < 0) { right = true; }
+
+		if (left && right) { return false; }
+	}
+
+	return true;
+}
+
+int NavigationMesh::FindPolygon(const Vec2& point) const
+{
+	for (int i = 0; i < GetNumberOfPolygons(); i++)
+	{
+		if (PolygonContainsPoint(i, point)) { return i; }
+	}
+
+	return -1;
+}
@@ -3,15 +3,47 @@
 #include "Vec2.h"
 #include <vector>
 #include "LineRenderer.h"
+#include "DelaunayTriangulation.h"
+#include "NavTriangle.h"
 
 class Grid;
 class Obstacle;
-struct Triangle;
 
 class NavigationMesh
 {
+	// Points the mesh is built from
 	std::vector<Vec2> mPoints;
-	std::vector<Triangle*> mTriangles;
+
+	// The finished mesh, kept as flat arrays that are only read once the mesh is built
+	std::vector<Vec2> mVertices;
+	std::vector<NavTriangle> mTriangles;
+	std::vector<NavNeighbours> mNeighbours;
+
+	// Convex polygons made by merging the triangles, packed one after another. Polygon i uses the vertices from
+	// mPolygonStarts[i] up to mPolygonStarts[i + 1], wound clockwise like the triangles
+	std::vector<int> mPolygonStarts;
+	std::vector<int> mPolygonVerts;
+	// Polygon on the other side of each polygon edge, lined up with mPolygonVerts. Edge j runs from vertex j to j + 1,
+	// -1 along the outside of the mesh
+	std::vector<int> mPolygonNeighbours;
+	// The polygon each triangle was merged into
+	std::vector<int> mTrianglePolygons;
+
+	// With merging off every triangle is its own polygon
+	bool mMergePolygons = true;
+
+	// Goes up every time the mesh is built, so anything worked out from the mesh can tell when it is out of date
+	int mVersion = 0;
+	// Delaunay flips made by the last build
+	int mFlipCount = 0;
+
+	TriangulationEngine mEngine = TriangulationEngine::INCREMENTAL;
+
+	// Input points closer together than this are merged into one vertex
+	float mWeldDistance = 0.0001f;
+
+	// Off by default, trades a bigger mesh for better shaped triangles
+	RefinementSettings mRefinement;
 
 public:
 	NavigationMesh();
@@ -24,11 +56,49 @@ public:
 	void Build(std::vector<Obstacle*>& obstacles);
 
 	std::vector<Vec2>& GetPoints() { return mPoints; }
-	std::vector<Triangle*>& GetTriangles() { return mTriangles; }
+	std::vector<Vec2>& GetVertices() { return mVertices; }
+	const std::vector<NavTriangle>& GetTriangles() const { return mTriangles; }
+
+	// Which triangulator the next Build uses
+	void SetEngine(TriangulationEngine engine) { mEngine = engine; }
+	TriangulationEngine GetEngine() const { return mEngine; }
+
+	void SetWeldDistance(float distance) { mWeldDistance = distance; }
+	float GetWeldDistance() const { return mWeldDistance; }
+
+	void SetRefinement(const RefinementSettings& refinement) { mRefinement = refinement; }
+	const RefinementSettings& GetRefinement() const { return mRefinement; }
+
+	void SetMergePolygons(bool merge) { mMergePolygons = merge; }
+	bool GetMergePolygons() const { return mMergePolygons; }
 
 	void AddPoint(Vec2 point) { mPoints.push_back(point); }
 	void AddPointList(std::vector<Vec2> pointList);
-	int GetNumberOfTriangles() { return (int)mTriangles.size(); }
-	Triangle* GetTriangleAtIndex(int index) { return mTriangles[index]; }
-};
+	int GetVersion() const { return mVersion; }
+	int GetNumberOfTriangles() const { return (int)mTriangles.size(); }
+	int GetFlipCount() const { return mFlipCount; }
 
+	const Vec2& GetVertex(int vertex) const { return mVertices[vertex]; }
+	const Vec2& GetTrianglePoint(int triangle, int corner) const { return mVertices[mTriangles[triangle].mVerts[corner]]; }
+	int GetNeighbour(int triangle, int edge) const { return mNeighbours[triangle].mTriangles[edge]; }
+	Vec2 GetTriangleCentre(int triangle) const;
+
+	int GetNumberOfPolygons() const { return mPolygonStarts.empty() ? 0 : (int)mPolygonStarts.size() - 1; }
+	int GetPolygonSize(int polygon) const { return mPolygonStarts[polygon + 1] - mPolygonStarts[polygon]; }
+	int GetPolygonVertex(int polygon, int corner) const { return mPolygonVerts[mPolygonStarts[polygon] + corner]; }
+	const Vec2& GetPolygonPoint(int polygon, int corner) const { return mVertices[GetPolygonVertex(polygon, corner)]; }
+	int GetPolygonNeighbour(int polygon, int edge) const { return mPolygonNeighbours[mPolygonStarts[polygon] + edge]; }
+	int GetTrianglePolygon(int triangle) const { return mTrianglePolygons[triangle]; }
+
+	// Area weighted centre, so long thin polygons don't pull it towards the end with more corners
+	Vec2 GetPolygonCentre(int polygon) const;
+	// Points on the edge count as inside
+	bool PolygonContainsPoint(int polygon, const Vec2& point) const;
+	// The polygon the point falls in, -1 if it is off the mesh
+	int FindPolygon(const Vec2& point) const;
+
+private:
+	// Hertel-Mehlhorn: removes edges between triangles as long as both ends of the edge stay convex, never removing
+	// an obstacle edge. The result has at most four times as many polygons as the fewest possible
+	void MergePolygons(const std::vector<bool>& constrainedEdges);
+};
@@ -1,134 +1,303 @@
 #include "NavigationUtilities.h"
 
 #include "Utility.h"
-#include "PathAgent.h"
-#include "World.h"
+#include "SearchContext.h"
+#include "PathQuery.h"
+#include "PathCache.h"
+#include "NodeGraph.h"
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <cfloat>
 
-std::vector<Vec2> AStarSearch(PathAgent* agent, Node* startNode, Node* endNode, const std::vector<Obstacle*>& obstacles)
+bool AStarSearch(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query, PathCache* cache)
 {
-	std::vector<Vec2> returnPath;
+	query.mPath.clear();
 
-	if (startNode == nullptr || endNode == nullptr) { std::cout << "Start or end node is null."; return returnPath; }
+	if (query.mStartNode == -1 || query.mEndNode == -1) { std::cout << "Start or end node is null."; return false; }
+	RedirectToReachable(graph, query);
 
-	if (startNode == endNode)
+	if (!cache || !cache->Find(query.mStartNode, query.mEndNode, query.mRadius, query.mSearch))
 	{
-		returnPath.push_back(startNode->mPosition);
-		return returnPath;
+		if (!FindNodePath(graph, query.mSearch, query.mStartNode, query.mEndNode))
+		{
+			std::cout << "Cannot path to end position. \n";
+			return false;
+		}
+
+		if (cache) { cache->Add(query.mStartNode, query.mEndNode, query.mRadius, query.mSearch); }
 	}
 
-	// Initialise start node
-	startNode->gScore = 0;
-	startNode->hScore = 0;
-	startNode->fScore = 0;
-	startNode->mPrevious = nullptr;
+	StringPull(graph, obstacles, query);
+	return true;
+}
 
-	// Create temp lists to sort which nodes we are visiting/visited
-	std::vector<Node*> mOpenList;
-	std::vector<Node*> mClosedList;
+bool FindNodePath(const NodeGraph& graph, SearchContext& context, int startNode, int endNode)
+{
+	StartNodeSearch(graph, context, startNode, endNode);
+	return ContinueNodeSearch(graph, context) == NodeSearchStatus::FOUND;
+}
 
-	mOpenList.push_back(startNode);
+void FindNodeCosts(const NodeGraph& graph, SearchContext& context, int startNode, const std::vector<int>& targetNodes, std::vector<float>& costs)
+{
+	costs.assign(targetNodes.size(), FLT_MAX);
+	context.Reset(graph.GetNodeCount());
+	if (startNode == -1) { return; }
+
+	// Each target node once, the search can stop when this runs out. Targets in other components are never reached
+	std::vector<int> remaining = targetNodes;
+	std::sort(remaining.begin(), remaining.end());
+	remaining.erase(std::unique(remaining.begin(), remaining.end()), remaining.end());
+	remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](int node) { return node == -1 || !graph.AreConnected(startNode, node); }), remaining.end());
+	int remainingCount = (int)remaining.size();
+
+	context.Open(startNode, 0, 0, -1);
+	while (remainingCount > 0 && !context.IsOpenEmpty())
+	{
+		int currentNode = context.PopLowest();
+		float currentScore = context.GetGScore(currentNode);
+		if (std::binary_search(remaining.begin(), remaining.end(), currentNode)) { remainingCount--; }
 
-	while (!mOpenList.empty())
+		for (int edge = graph.GetEdgeStart(currentNode); edge < graph.GetEdgeEnd(currentNode); edge++)
+		{
+			int target = graph.GetEdgeTarget(edge);
+			if (context.IsClosed(target)) { continue; }
+
+			float gScore = currentScore + graph.GetEdgeCost(edge);
+			context.Open(target, gScore, gScore, currentNode);
+		}
+	}
+
+	for (size_t i = 0; i < targetNodes.size(); i++)
 	{
-		// (this currently works but need to be adjusted as we are not comparing the right thing)
-		// Sort by fscore
-		std::sort(mOpenList.begin(), mOpenList.end(), [](Node* lhs, Node* rhs) { return lhs->fScore < rhs->fScore; });
-		Node* currentNode = mOpenList[0];
+		if (targetNodes[i] != -1 && context.IsClosed(targetNodes[i])) { costs[i] = context.GetGScore(targetNodes[i]); }
+	}
+}
 
-		// Reached our destination
-		if (currentNode == endNode) { break; }
+void FindPathsToPoints(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query, const std::vector<Vec2>& ends, std::vector<float>& costs, std::vector<std::vector<Vec2>>* paths)
+{
+	std::vector<int> endNodes(ends.size());
+	for (size_t i = 0; i < ends.size(); i++)
+	{
+		endNodes[i] = graph.GetClosestNode(ends[i]);
+	}
 
-		// Remove the node we are checking from our list and put into our closed list
-		mOpenList.erase(mOpenList.begin());
-		mClosedList.push_back(currentNode);
+	FindNodeCosts(graph, query.mSearch, query.mStartNode, endNodes, costs);
+	if (!paths) { return; }
+
+	Vec2 end = query.mEnd;
+	paths->resize(ends.size());
+	for (size_t i = 0; i < ends.size(); i++)
+	{
+		(*paths)[i].clear();
+		if (costs[i] == FLT_MAX) { continue; }
+
+		query.mSearch.BuildPath(endNodes[i]);
+		query.mEnd = ends[i];
+		StringPull(graph, obstacles, query);
+		(*paths)[i] = query.mPath;
+	}
+	query.mEnd = end;
+}
+
+void FindPathsFromPoints(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query, const std::vector<Vec2>& starts, std::vector<float>& costs, std::vector<std::vector<Vec2>>* paths)
+{
+	std::vector<int> startNodes(starts.size());
+	for (size_t i = 0; i < starts.size(); i++)
+	{
+		startNodes[i] = graph.GetClosestNode(starts[i]);
+	}
+
+	FindNodeCosts(graph, query.mSearch, query.mEndNode, startNodes, costs);
+	if (!paths) { return; }
+
+	Vec2 start = query.mStart;
+	paths->resize(starts.size());
+	for (size_t i = 0; i < starts.size(); i++)
+	{
+		(*paths)[i].clear();
+		if (costs[i] == FLT_MAX) { continue; }
+
+		// The search went out from the end, so the node path comes back the wrong way round
+		query.mSearch.BuildPath(startNodes[i]);
+		std::reverse(query.mSearch.GetPath().begin(), query.mSearch.GetPath().end());
+		query.mStart = starts[i];
+		StringPull(graph, obstacles, query);
+		(*paths)[i] = query.mPath;
+	}
+	query.mStart = start;
+}
+
+bool RedirectToReachable(const NodeGraph& graph, PathQuery& query)
+{
+	if (!query.mRedirectUnreachable || query.mStartNode == -1 || query.mEndNode == -1 ||
+		graph.AreConnected(query.mStartNode, query.mEndNode))
+	{
+		return false;
+	}
+
+	int node;
+	query.mEnd = graph.FindClosestPointInComponent(graph.GetComponent(query.mStartNode), query.mEnd, node);
+	query.mEndNode = node;
+	return true;
+}
+
+void StartNodeSearch(const NodeGraph& graph, SearchContext& context, int startNode, int endNode)
+{
+	context.Reset(graph.GetNodeCount(), endNode);
 
-		// Check each connection to find the lowest costing path of travel
-		for (Edge c : currentNode->mConnections)
+	// Leaving the open list empty ends the search straight away
+	if (startNode == -1 || endNode == -1 || !graph.AreConnected(startNode, endNode)) { return; }
+
+	context.Open(startNode, 0, graph.EstimateCost(startNode, endNode), -1);
+}
+
+NodeSearchStatus ContinueNodeSearch(const NodeGraph& graph, SearchContext& context, int maxExpansions, int maxMicroseconds)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	int endNode = context.GetEndNode();
+
+	for (int expansions = 0; !context.IsOpenEmpty(); expansions++)
+	{
+		if (maxExpansions > 0 && expansions >= maxExpansions) { return NodeSearchStatus::IN_PROGRESS; }
+
+		// Reading the clock costs more than an expansion, so only check it every few
+		if (maxMicroseconds > 0 && expansions > 0 && expansions % 16 == 0 &&
+			std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count() >= maxMicroseconds)
 		{
-			// Skip the node if we have already visited it
-			if (std::find(mClosedList.begin(), mClosedList.end(), c.mTarget) != mClosedList.end()) { continue; }
+			return NodeSearchStatus::IN_PROGRESS;
+		}
 
-			c.mTarget->gScore = currentNode->gScore + c.mCost;
-			c.mTarget->hScore = std::abs(c.mTarget->mPosition.x - endNode->mPosition.x) + std::abs(c.mTarget->mPosition.y - endNode->mPosition.y);
-			c.mTarget->fScore = c.mTarget->hScore + c.mTarget->gScore;
+		int currentNode = context.PopLowest();
+		float currentScore = context.GetGScore(currentNode);
+		// Straight line rather than the heuristic, which with landmarks doesn't say how near the node is to the end
+		context.AddExpansion(currentNode, (graph.GetPosition(currentNode) - graph.GetPosition(endNode)).GetMagnitude());
 
-			// Haven't visited the node yet
-			if (std::find(mOpenList.begin(), mOpenList.end(), c.mTarget) == mOpenList.end())
-			{
-				c.mTarget->gScore = currentNode->gScore;
-				c.mTarget->fScore = currentNode->fScore;
-				c.mTarget->mPrevious = currentNode;
-				mOpenList.push_back(c.mTarget);
-			}
+		// Reached our destination
+		if (currentNode == endNode)
+		{
+			context.BuildPath(endNode);
+			return NodeSearchStatus::FOUND;
+		}
 
-			// Already visited, compare scores to find the shortest path
-			else if (currentNode->fScore < c.mTarget->fScore)
-			{
-				c.mTarget->gScore = currentNode->gScore;
-				c.mTarget->fScore = currentNode->hScore;
-				c.mTarget->mPrevious = currentNode;
-			}
+		for (int edge = graph.GetEdgeStart(currentNode); edge < graph.GetEdgeEnd(currentNode); edge++)
+		{
+			int target = graph.GetEdgeTarget(edge);
+			if (context.IsClosed(target)) { continue; }
+
+			float gScore = currentScore + graph.GetEdgeCost(edge);
+			context.Open(target, gScore, gScore + graph.EstimateCost(target, endNode), currentNode);
 		}
 	}
 
-	// Check to see if the path is navigatable
-	if (std::find(mOpenList.begin(), mOpenList.end(), endNode) == mOpenList.end())
+	return NodeSearchStatus::NOT_FOUND;
+}
+
+void StartPathSearch(const NodeGraph& graph, PathQuery& query)
+{
+	query.mPath.clear();
+	query.mSearchTime = 0;
+	RedirectToReachable(graph, query);
+	StartNodeSearch(graph, query.mSearch, query.mStartNode, query.mEndNode);
+}
+
+PathSearchStatus ContinuePathSearch(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query)
+{
+	// Never let one slice run past the time limit
+	int sliceTime = query.mSliceMicroseconds;
+	if (query.mTimeLimit > 0)
+	{
+		int remaining = std::max(1, query.mTimeLimit - (int)query.mSearchTime);
+		sliceTime = sliceTime > 0 ? std::min(sliceTime, remaining) : remaining;
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+	NodeSearchStatus status = ContinueNodeSearch(graph, query.mSearch, query.mSliceExpansions, sliceTime);
+	query.mSearchTime += std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+
+	if (status == NodeSearchStatus::FOUND)
+	{
+		StringPull(graph, obstacles, query);
+		return PathSearchStatus::COMPLETE;
+	}
+
+	if (status == NodeSearchStatus::NOT_FOUND) { return PathSearchStatus::FAILED; }
+
+	if (query.mTimeLimit > 0 && query.mSearchTime >= query.mTimeLimit)
 	{
-		std::cout << "Cannot path to end position. \n";
-		return std::vector<Vec2>{};
+		return StopPathSearch(graph, obstacles, query);
 	}
 
-	// Reverse the path
-	std::vector<Node*> path;
-	Node* currentNode = endNode;
+	return PathSearchStatus::IN_PROGRESS;
+}
 
-	while (currentNode != nullptr)
+PathSearchStatus StopPathSearch(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query)
+{
+	SearchContext& context = query.mSearch;
+	if (!query.mAllowPartialPath || context.GetClosestNode() == -1)
 	{
-		path.insert(path.begin(), currentNode);
-		currentNode = currentNode->mPrevious;
+		query.mPath.clear();
+		return PathSearchStatus::FAILED;
 	}
 
-	std::vector<Vec2> vectorPath = StringPull(agent,path, obstacles);
-	return vectorPath;
+	// Head for the middle of the closest node instead of the end
+	context.BuildPath(context.GetClosestNode());
+	query.mEnd = graph.GetPosition(context.GetClosestNode());
+	StringPull(graph, obstacles, query);
+	return PathSearchStatus::PARTIAL;
+}
+
+float GetPortalClearance(float radius)
+{
+	return radius * 4;
 }
 
-std::vector<Vec2> StringPull(PathAgent* agent, std::vector<Node*>& path, const std::vector<Obstacle*>& obstacles)
+void StringPull(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query)
 {
-	agent->ClearPortals();
-	agent->pathedges.clear();
+	const std::vector<int>& path = query.mSearch.GetPath();
+	std::vector<std::vector<Vec2>>& portals = query.mPortals;
+	std::vector<Vec2>& returnPath = query.mPath;
+
+	returnPath.clear();
+	query.mPortalLefts.clear();
+	query.mPortalRights.clear();
 
-	std::vector<std::vector<Vec2>> portals;
+	if (path.size() == 1)
+	{
+		portals.clear();
+		returnPath.push_back(graph.GetPosition(path[0]));
+		return;
+	}
 
-	for (size_t i = path.size() - 1; i >= 1; i--)
+	// Each connection already knows the polygon edge it crosses
+	portals.resize(path.size() - 1);
+	for (size_t i = 0; i + 1 < path.size(); i++)
 	{
-		std::vector<Vec2> edge = FindTwoCommonVerts(path[i]->mTriangle, path[i - 1]->mTriangle);
-		agent->pathedges.push_back(edge);
-		portals.insert(portals.begin(), edge);
+		int connection = graph.FindEdge(path[i + 1], path[i]);
+		portals[i].assign({ graph.GetPortalStart(connection), graph.GetPortalEnd(connection) });
 	}
 
-	Vec2 funnelTip = agent->GetPosition();
+	Vec2 funnelTip = query.mStart;
 	Vec2 endPos;
-	if (IsPointInObstacle(agent->GetEndPos(), agent->GetWorld()->GetObstacles(), 10000))
+	if (IsPointInObstacle(query.mEnd, obstacles, 10000))
 	{
-		endPos = path[path.size() - 1]->mPosition;
+		endPos = graph.GetPosition(path[path.size() - 1]);
 	}
-	else { endPos = agent->GetEndPos(); }
+	else { endPos = query.mEnd; }
 
 
 	// check to see if a direct line of sight is available
 	// if yes, move directly to end pos
-	std::vector<Vec2> returnPath;
 	returnPath.push_back(funnelTip);
 	if (!DoLinesIntersect(funnelTip, endPos, obstacles))
 	{
 		returnPath.push_back(endPos);
-		return returnPath;
+		return;
 	}
 
 	// otherwise do funnel algorithm
-	float agentRadius = agent->GetRadius() * 4;
+	float agentRadius = GetPortalClearance(query.mRadius);
 	Vec2 portalRight = ReturnRightPoint(portals[0], funnelTip);
 	Vec2 portalLeft = ReturnLeftPoint(portals[0], funnelTip);
 	Vec2 direction = (portalRight - portalLeft).Normalise();
@@ -136,8 +305,8 @@ std::vector<Vec2> StringPull(PathAgent* agent, std::vector<Node*>& path, const s
 	portalRight = portalRight - direction * agentRadius;
 	portalLeft = portalLeft + direction * agentRadius;
 
-	agent->AddPortalRight(portalRight);
-	agent->AddPortalLeft(portalLeft);
+	query.mPortalRights.push_back(portalRight);
+	query.mPortalLefts.push_back(portalLeft);
 
 	Vec2 left;
 	Vec2 right;
@@ -146,15 +315,15 @@ std::vector<Vec2> StringPull(PathAgent* agent, std::vector<Node*>& path, const s
 
 	for (int i = 0; i < portals.size(); i++)
 	{
-		left = ReturnLeftPoint(portals[i], path[i]->mPosition);
-		right = ReturnRightPoint(portals[i], path[i]->mPosition);
+		left = ReturnLeftPoint(portals[i], graph.GetPosition(path[i]));
+		right = ReturnRightPoint(portals[i], graph.GetPosition(path[i]));
 		direction = (right - left).Normalise();
 
 		right -= direction * agentRadius;
 		left += direction * agentRadius;
 
-		agent->AddPortalRight(right);
-		agent->AddPortalLeft(left);
+		query.mPortalRights.push_back(right);
+		query.mPortalLefts.push_back(left);
 
 		if (PseudoCross(portalLeft - funnelTip, left - funnelTip) <= 0.0f)
 		{
@@ -170,8 +339,8 @@ std::vector<Vec2> StringPull(PathAgent* agent, std::vector<Node*>& path, const s
 			if (!DoLinesIntersect(Vec2(funnelTip.x - agentRadius, funnelTip.y - agentRadius), endPos, obstacles) &&
 				!DoLinesIntersect(Vec2(funnelTip.x + agentRadius, funnelTip.y + agentRadius), endPos, obstacles))
 			{
-				returnPath.push_back(path[path.size() - 1]->mPosition);
-				return returnPath;
+				returnPath.push_back(graph.GetPosition(path[path.size() - 1]));
+				return;
 			}
 			i--;
 			continue;
@@ -190,17 +359,15 @@ std::vector<Vec2> StringPull(PathAgent* agent, std::vector<Node*>& path, const s
 			if (!DoLinesIntersect(Vec2(funnelTip.x - agentRadius, funnelTip.y - agentRadius ), endPos, obstacles) && 
 				!DoLinesIntersect(Vec2(funnelTip.x + agentRadius , funnelTip.y + agentRadius ), endPos, obstacles))
 			{
-				returnPath.push_back(path[path.size() - 1]->mPosition);
-				return returnPath;
+				returnPath.push_back(graph.GetPosition(path[path.size() - 1]));
+				return;
 			}
 			i--;
 		}
 	}
 
 	returnPath.push_back(FindShortestPortal(portalLeft, portalRight, funnelTip));
-	path.erase(path.begin() + path.size() - 1);
 	returnPath.push_back(endPos);
-	return returnPath;
 }
 
 Vec2 FindShortestPortal(const Vec2& left, const Vec2& right, Vec2& endPos)
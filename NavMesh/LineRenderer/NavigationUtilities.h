@@ -1,12 +1,54 @@
 #pragma once
 
-#include "Node.h"
+#include "Vec2.h"
+#include <vector>
 
 class Obstacle;
-class PathAgent;
+class NodeGraph;
+class SearchContext;
+class PathCache;
+struct PathQuery;
+enum class NodeSearchStatus;
+enum class PathSearchStatus;
 
-std::vector<Vec2> AStarSearch(PathAgent* agent, Node* startNode, Node* endNode, const std::vector<Obstacle*>& obstacles);
-std::vector<Vec2> StringPull(PathAgent* agent, std::vector<Node*>& path, const std::vector<Obstacle*>& obstacles);
+// Finds a path for the query by searching the graph and then pulling a string through the portals, false if there isn't one
+// Only the query is written to, so queries with their own PathQuery can share the graph and obstacles across threads
+// With a cache, node paths found before skip the search and go straight to string pulling
+bool AStarSearch(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query, PathCache* cache = nullptr);
+// Searches the graph with A*, leaving the nodes of the path in the context. Returns false if the end can't be reached
+// Nodes in different components are turned down straight away
+bool FindNodePath(const NodeGraph& graph, SearchContext& context, int startNode, int endNode);
+
+// One Dijkstra search out from the start that stops once every target node has been reached, far cheaper than a search
+// per target. costs[i] is the cost between node centres to targetNodes[i], FLT_MAX if it can't be reached
+// The context is left holding the search, so BuildPath gives the node path to any target afterwards
+void FindNodeCosts(const NodeGraph& graph, SearchContext& context, int startNode, const std::vector<int>& targetNodes, std::vector<float>& costs);
+// Costs, and paths when asked for, from the query's start to each end. paths[i] is empty if ends[i] can't be reached
+// The query's end is moved to each end in turn while pulling the paths, and put back afterwards
+void FindPathsToPoints(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query, const std::vector<Vec2>& ends, std::vector<float>& costs, std::vector<std::vector<Vec2>>* paths = nullptr);
+// The reverse, from each start to the query's end. Connections cost the same both ways, so this is one search out from the end
+// Likewise the query's start is moved to each start in turn and put back afterwards
+void FindPathsFromPoints(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query, const std::vector<Vec2>& starts, std::vector<float>& costs, std::vector<std::vector<Vec2>>* paths = nullptr);
+
+// Moves the query's end to the closest point the start can reach, if it is turned on and the end can't be reached
+// Returns true if the end was moved
+bool RedirectToReachable(const NodeGraph& graph, PathQuery& query);
+
+// FindNodePath split up so the search can be paused, and carried on later from where it stopped
+void StartNodeSearch(const NodeGraph& graph, SearchContext& context, int startNode, int endNode);
+// Expands nodes until the search ends or either limit is hit, limits of 0 are ignored
+NodeSearchStatus ContinueNodeSearch(const NodeGraph& graph, SearchContext& context, int maxExpansions = 0, int maxMicroseconds = 0);
+
+// Time sliced version of AStarSearch, each call to ContinuePathSearch runs within the query's slice limits
+// The path is pulled once the search finishes, and a search that goes over the query's time limit is stopped
+void StartPathSearch(const NodeGraph& graph, PathQuery& query);
+PathSearchStatus ContinuePathSearch(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query);
+// Gives up on a search part way through, pulling a path towards the closest node reached if the query allows it
+PathSearchStatus StopPathSearch(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query);
+// Turns the node path in the query's search context into the query's path, replacing anything already in it
+void StringPull(const NodeGraph& graph, const std::vector<Obstacle*>& obstacles, PathQuery& query);
+// How far an agent keeps from the ends of a portal when crossing it, the same for paths and flow fields
+float GetPortalClearance(float radius);
 
 Vec2 FindShortestPortal(const Vec2& left, const Vec2& right, Vec2& endPos);
 Vec2 ReturnRightPoint(const std::vector<Vec2>& points, const Vec2& position);
@@ -7,86 +7,164 @@
 #include "Utility.h"
 #include "NavigationMesh.h"
 #include "DelaunayTriangulation.h"
-#include "Triangle.h"
+#include "Maths.h"
 
-NodeGraph::NodeGraph(NavigationMesh* navMesh) : mNavMesh(navMesh)
+NodeGraph::NodeGraph(const NavigationMesh* navMesh) : mNavMesh(navMesh)
 {
-	ConstructNodeNeighbours(mNavMesh->GetTriangles());
+	ConstructNodeNeighbours();
 }
 
-NodeGraph::~NodeGraph()
+void NodeGraph::ConstructNodeNeighbours()
 {
-	for (Node* n : mNodes)
+	int polygonCount = mNavMesh->GetNumberOfPolygons();
+
+	mPositions.clear();
+	mEdgeStarts.clear();
+	mEdgeTargets.clear();
+	mEdgeCosts.clear();
+	mPortalStarts.clear();
+	mPortalEnds.clear();
+	mLandmarks.Clear();
+
+	for (int i = 0; i < polygonCount; i++)
 	{
-		delete n;
+		mPositions.push_back(mNavMesh->GetPolygonCentre(i));
 	}
-}
+	
+	// Node i sits on polygon i, so the mesh's neighbour array gives the connections directly
+	for (int i = 0; i < polygonCount; i++)
+	{
+		int rowStart = (int)mEdgeTargets.size();
+		mEdgeStarts.push_back(rowStart);
 
-Node* NodeGraph::GetNodeAt(int index) const
-{
-	if (mNodes.empty()) { return nullptr; }
-	return mNodes[index];
+		for (int edge = 0; edge < mNavMesh->GetPolygonSize(i); edge++)
+		{
+			int adjacentPolygon = mNavMesh->GetPolygonNeighbour(i, edge);
+			if (adjacentPolygon == -1) { continue; }
+
+			// Polygons that share a straight run of edges only get one connection
+			if (std::find(mEdgeTargets.begin() + rowStart, mEdgeTargets.end(), adjacentPolygon) != mEdgeTargets.end()) { continue; }
+
+			std::vector<Vec2> portal = FindTwoCommonVerts(*mNavMesh, i, adjacentPolygon);
+
+			mEdgeTargets.push_back(adjacentPolygon);
+			mEdgeCosts.push_back((mPositions[i] - mPositions[adjacentPolygon]).GetMagnitude());
+			mPortalStarts.push_back(portal[0]);
+			mPortalEnds.push_back(portal[1]);
+		}
+	}
+	mEdgeStarts.push_back((int)mEdgeTargets.size());
+
+	LabelComponents();
 }
 
-void NodeGraph::ConstructNodeNeighbours(std::vector<Triangle*>& triangleList)
+void NodeGraph::LabelComponents()
 {
-	mNodes.clear();
-	
-	for (int i = 0; i < (int)triangleList.size(); i++)
-	{
-		Node* node = new Node(GetTriangleCentre(triangleList[i]), triangleList[i]);
-		mNodes.push_back(node);
-	}
-	
-	for(int i = 0; i < (int)mNodes.size(); i++)
+	int nodeCount = GetNodeCount();
+	mComponents.assign(nodeCount, -1);
+	mComponentStarts.clear();
+	mComponentNodes.clear();
+
+	// Flood out from each node that hasn't been reached yet, the nodes of each component end up next to each other
+	for (int i = 0; i < nodeCount; i++)
 	{
-		std::vector<Vec2> edgeList[3];
-		edgeList[0] = { triangleList[i]->mPoints[0], triangleList[i]->mPoints[1] };
-		edgeList[1] = { triangleList[i]->mPoints[1], triangleList[i]->mPoints[2] };
-		edgeList[2] = { triangleList[i]->mPoints[2], triangleList[i]->mPoints[0] };
-	
-		for (std::vector<Vec2> e : edgeList)
+		if (mComponents[i] != -1) { continue; }
+
+		int component = (int)mComponentStarts.size();
+		int componentStart = (int)mComponentNodes.size();
+		mComponentStarts.push_back(componentStart);
+		mComponents[i] = component;
+		mComponentNodes.push_back(i);
+
+		for (int next = componentStart; next < (int)mComponentNodes.size(); next++)
 		{
-			Triangle* adjacentTriangle = FindAdjacentTriangleToEdge(i, e, triangleList);
-			if (adjacentTriangle == nullptr) { continue; }
-	
-			Node* connectionNode = GetNode(GetTriangleCentre(adjacentTriangle));
-			if (connectionNode == nullptr) { continue; }
-	
-			float nodeCost = (mNodes[i]->mPosition - connectionNode->mPosition).GetMagnitude();
-			mNodes[i]->ConnectToNode(connectionNode, nodeCost);
+			int node = mComponentNodes[next];
+			for (int edge = GetEdgeStart(node); edge < GetEdgeEnd(node); edge++)
+			{
+				int target = mEdgeTargets[edge];
+				if (mComponents[target] != -1) { continue; }
+
+				mComponents[target] = component;
+				mComponentNodes.push_back(target);
+			}
 		}
 	}
+	mComponentStarts.push_back((int)mComponentNodes.size());
 }
 
+int NodeGraph::FindEdge(int from, int to) const
+{
+	for (int edge = GetEdgeStart(from); edge < GetEdgeEnd(from); edge++)
+	{
+		if (mEdgeTargets[edge] == to) { return edge; }
+	}
+
+	return -1;
+}
+
+float NodeGraph::EstimateCost(int from, int to) const
+{
+	// Every connection costs the distance between the node centres, so the straight line never overestimates
+	float estimate = (mPositions[from] - mPositions[to]).GetMagnitude();
+	if (mLandmarks.IsBuilt()) { estimate = std::max(estimate, mLandmarks.EstimateCost(from, to)); }
+	return estimate;
+}
 
-Node* NodeGraph::GetClosestNode(Vec2 pos)
+Vec2 NodeGraph::FindClosestPointInComponent(int component, const Vec2& pos, int& node) const
 {
+	Vec2 closestPoint = pos;
 	float closestDistance = FLT_MAX;
-	std::vector<Triangle*> triList = mNavMesh->GetTriangles();
-	int triIndex = 0;
-	
-	for (int i = 0; i < triList.size(); i++)
+	node = -1;
+
+	for (int i = mComponentStarts[component]; i < mComponentStarts[component + 1]; i++)
 	{
-		float result = (GetTriangleCentre(triList[i]) - pos).GetMagnitude();
-		if (result < closestDistance)
+		int polygon = mComponentNodes[i];
+		if (mNavMesh->PolygonContainsPoint(polygon, pos))
 		{
-			closestDistance = result;
-			triIndex = i;
+			node = polygon;
+			return pos;
+		}
+
+		// Otherwise the closest point is on one of the polygon's edges
+		int size = mNavMesh->GetPolygonSize(polygon);
+		for (int corner = 0; corner < size; corner++)
+		{
+			const Vec2& start = mNavMesh->GetPolygonPoint(polygon, corner);
+			Vec2 edge = mNavMesh->GetPolygonPoint(polygon, (corner + 1) % size) - start;
+			float t = Clamp(Dot(pos - start, edge) / edge.GetMagnitudeSquared(), 0.0f, 1.0f);
+			Vec2 point = start + edge * t;
+
+			float distance = (point - pos).GetMagnitudeSquared();
+			if (distance < closestDistance)
+			{
+				closestDistance = distance;
+				closestPoint = point;
+				node = polygon;
+			}
 		}
 	}
-	
-	return GetNodeAt(triIndex);
+
+	return closestPoint;
 }
 
-Node* NodeGraph::GetNode(Vec2 pos) 
+int NodeGraph::GetClosestNode(Vec2 pos) const
 {
-	for(Node* n : mNodes)
+	// Use the polygon the position is in, otherwise the closest centre
+	int polygon = mNavMesh->FindPolygon(pos);
+	if (polygon != -1) { return polygon; }
+
+	float closestDistance = FLT_MAX;
+	int closestNode = -1;
+	
+	for (int i = 0; i < GetNodeCount(); i++)
 	{
-		if(n->mPosition == pos)
+		float result = (mPositions[i] - pos).GetMagnitude();
+		if (result < closestDistance)
 		{
-			return n;
+			closestDistance = result;
+			closestNode = i;
 		}
 	}
-	return nullptr;
+	
+	return closestNode;
 }
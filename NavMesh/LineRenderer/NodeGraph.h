@@ -1,33 +1,74 @@
 #pragma once
 
-#include "Node.h"
+#include "Vec2.h"
+#include "LandmarkTable.h"
 #include <vector>
 
 class Obstacle;
 class LineRenderer;
 class NavigationMesh;
-struct Triangle;
 
+// Only read once it is built, so any number of threads can search it at the same time
 class NodeGraph
 {
-	// List of all the nodes in the map
-	NavigationMesh* mNavMesh = nullptr;
-	std::vector<Node*> mNodes;
+	const NavigationMesh* mNavMesh = nullptr;
+
+	// Node i sits at the centre of polygon i in the navigation mesh
+	std::vector<Vec2> mPositions;
+
+	// Connections are packed in rows, the ones leaving node i are mEdgeStarts[i] up to mEdgeStarts[i + 1] in the edge arrays
+	std::vector<int> mEdgeStarts;
+	std::vector<int> mEdgeTargets;
+	std::vector<float> mEdgeCosts;
+	// Ends of the polygon edge each connection crosses, these are the portals when string pulling
+	std::vector<Vec2> mPortalStarts;
+	std::vector<Vec2> mPortalEnds;
+
+	// Nodes that can reach each other share a component. The nodes of component i are mComponentStarts[i] up to
+	// mComponentStarts[i + 1] in mComponentNodes
+	std::vector<int> mComponents;
+	std::vector<int> mComponentStarts;
+	std::vector<int> mComponentNodes;
+
+	// Empty until BuildLandmarks is called or a table is loaded
+	LandmarkTable mLandmarks;
 
 public:
-	NodeGraph(NavigationMesh* navMesh);
-	~NodeGraph();
-	Node* GetNodeAt(int index) const;
-	void ConstructNodeNeighbours(std::vector<Triangle*>& triangleList);
+	NodeGraph(const NavigationMesh* navMesh);
+	void ConstructNodeNeighbours();
 
-	void AddNode(Node* node) { mNodes.push_back(node); }
+	int GetNodeCount() const { return (int)mPositions.size(); }
+	const Vec2& GetPosition(int node) const { return mPositions[node]; }
 
-	std::vector<Node*> GetNodeList() { return mNodes; }
-	int GetNodeListSize() const { return (int)mNodes.size(); }
+	// Connections of a node are the edges from GetEdgeStart up to GetEdgeEnd
+	int GetEdgeStart(int node) const { return mEdgeStarts[node]; }
+	int GetEdgeEnd(int node) const { return mEdgeStarts[node + 1]; }
+	int GetEdgeTarget(int edge) const { return mEdgeTargets[edge]; }
+	float GetEdgeCost(int edge) const { return mEdgeCosts[edge]; }
+	const Vec2& GetPortalStart(int edge) const { return mPortalStarts[edge]; }
+	const Vec2& GetPortalEnd(int edge) const { return mPortalEnds[edge]; }
 
-	Node* GetClosestNode(Vec2 pos);
-	Node* GetNode(Vec2 pos);
-	NavigationMesh* GetNavMesh() { return mNavMesh; }
-	Node* GetNodeAtIndex(int index) { return mNodes[index]; }
-};
+	// The connection from one node to another, -1 if they aren't connected
+	int FindEdge(int from, int to) const;
 
+	int GetComponent(int node) const { return mComponents[node]; }
+	int GetComponentCount() const { return mComponentStarts.empty() ? 0 : (int)mComponentStarts.size() - 1; }
+	// Whether a path between the nodes exists, without searching
+	bool AreConnected(int from, int to) const { return mComponents[from] == mComponents[to]; }
+	// The point in a component closest to the position, and the node it is in
+	Vec2 FindClosestPointInComponent(int component, const Vec2& pos, int& node) const;
+
+	// Lower bound on the cost between two nodes, the A* heuristic. Uses the landmarks once they are built
+	float EstimateCost(int from, int to) const;
+	void BuildLandmarks(int landmarkCount) { mLandmarks.Build(*this, landmarkCount); }
+	LandmarkTable& GetLandmarks() { return mLandmarks; }
+	const LandmarkTable& GetLandmarks() const { return mLandmarks; }
+
+	// The node whose polygon the position is in, or the closest one when it is off the mesh. -1 if there are no nodes
+	int GetClosestNode(Vec2 pos) const;
+	const NavigationMesh* GetNavMesh() const { return mNavMesh; }
+
+private:
+	// Works out the components once the connections are made
+	void LabelComponents();
+};
@@ -2,30 +2,44 @@
 
 #include "dirent.h"
 #include "World.h"
-#include "NavigationUtilities.h"
+#include "PathScheduler.h"
+#include "FlowField.h"
 #include "TextStream.h"
 #include "LineRenderer.h"
 
-PathAgent::PathAgent(NodeGraph* nodeGraph, float width, Colour colour, World* world) : mNodeGraph(nodeGraph), mRadius(width), mColour(colour), mCurrentWorld(world)
+PathAgent::PathAgent(const NodeGraph* nodeGraph, float width, Colour colour, World* world) : mNodeGraph(nodeGraph), mRadius(width), mColour(colour), mCurrentWorld(world)
 {
-	mCurrentNode = mNodeGraph->GetNodeAt(0);
-	mPosition = mCurrentNode->mPosition;
+	mCurrentNode = 0;
+	mPosition = mNodeGraph->GetPosition(mCurrentNode);
 }
 
 void PathAgent::Update(float deltaTime)
 {
-	int randNum = rand() % mNodeGraph->GetNodeList().size() - 1;
+	int randNum = rand() % mNodeGraph->GetNodeCount() - 1;
 	if (randNum < 0) { randNum = 0; }
 	//if (mNodePath.empty() && mPointPath.empty()) { return; }
 
-	if(mPointPath.empty()) { GoToNode(mNodeGraph->GetNodeAtIndex(randNum)); }
+	if (mFlowField)
+	{
+		NavigateFlowField(deltaTime);
+		return;
+	}
+
+	// Switch over to the requested path once the scheduler hands it back
+	if (mPathRequest != -1 && mCurrentWorld->GetPathScheduler()->TakePath(mPathRequest, mPointPath))
+	{
+		mPathRequest = -1;
+		mCurrentIndex = 0;
+	}
+
+	if(mPointPath.empty() && mPathRequest == -1) { GoToNode(randNum); }
 
 	 NavigatePointPath(deltaTime);
 }
 
 void PathAgent::NavigateNodePath(float deltaTime)
 {
-	Node* nextNode;
+	int nextNode;
 	if (mCurrentIndex + 1 >= (int)mNodePath.size())
 	{
 		nextNode = mCurrentNode;
@@ -35,7 +49,7 @@ void PathAgent::NavigateNodePath(float deltaTime)
 		nextNode = mNodePath[mCurrentIndex + 1];
 	}
 
-	Vec2 mag = nextNode->mPosition - mPosition;
+	Vec2 mag = mNodeGraph->GetPosition(nextNode) - mPosition;
 	float distance = sqrtf((mag.x * mag.x) + (mag.y * mag.y));
 	mag /= distance;
 
@@ -50,19 +64,19 @@ void PathAgent::NavigateNodePath(float deltaTime)
 		mCurrentIndex++;
 		if (mCurrentIndex >= (int)mNodePath.size())
 		{
-			mPosition = mCurrentNode->mPosition;
+			mPosition = mNodeGraph->GetPosition(mCurrentNode);
 			mNodePath.clear();
 		}
 		else
 		{
-			Node* previousNode = mCurrentNode;
+			int previousNode = mCurrentNode;
 			mCurrentNode = mNodePath[mCurrentIndex];
 
-			Vec2 nextMag = previousNode->mPosition - mCurrentNode->mPosition;
+			Vec2 nextMag = mNodeGraph->GetPosition(previousNode) - mNodeGraph->GetPosition(mCurrentNode);
 			float nextDistance = sqrtf((nextMag.x * nextMag.x) * (nextMag.y * nextMag.y));
 
 			nextMag /= nextDistance;
-			mPosition = mCurrentNode->mPosition - distance * nextMag;
+			mPosition = mNodeGraph->GetPosition(mCurrentNode) - distance * nextMag;
 		}
 	}
 }
@@ -99,10 +113,10 @@ void PathAgent::NavigatePointPath(float deltaTime)
 		}
 		else
 		{
-			Node* previousNode = mCurrentNode;
+			int previousNode = mCurrentNode;
 			mCurrentNode = mNodeGraph->GetClosestNode(mPointPath[mCurrentIndex]);
 
-			Vec2 nextMag = previousNode->mPosition - mPosition;
+			Vec2 nextMag = mNodeGraph->GetPosition(previousNode) - mPosition;
 			float nextDistance = sqrtf((nextMag.x * nextMag.x) * (nextMag.y * nextMag.y));
 
 			nextMag /= nextDistance;
@@ -111,6 +125,32 @@ void PathAgent::NavigatePointPath(float deltaTime)
 	}
 }
 
+void PathAgent::NavigateFlowField(float deltaTime)
+{
+	if (mCurrentNode == -1 || !mFlowField->IsReachable(mCurrentNode))
+	{
+		mFlowField = nullptr;
+		return;
+	}
+
+	Vec2 target = mFlowField->GetSteeringTarget(mCurrentNode, mPosition, mRadius);
+	Vec2 mag = target - mPosition;
+	float distance = mag.GetMagnitude();
+	float step = mSpeed * deltaTime;
+
+	if (distance > step)
+	{
+		mPosition += mag * (step / distance);
+		return;
+	}
+
+	// Standing on the edge into the next node, or at the goal
+	mPosition = target;
+	int nextNode = mFlowField->GetNextNode(mCurrentNode);
+	if (nextNode == -1) { mFlowField = nullptr; }
+	else { mCurrentNode = nextNode; }
+}
+
 void PathAgent::Draw(LineRenderer* lines)
 {
 	lines->DrawCircle(mPosition, mRadius, mColour);
@@ -141,21 +181,39 @@ void PathAgent::Draw(LineRenderer* lines)
 	//}
 }
 
-void PathAgent::GoToNode(Node* destination)
+void PathAgent::GoToNode(int destination)
 {
-	if (destination == nullptr) { return; }
-	mCurrentIndex = 0;
+	if (destination == -1) { return; }
+	mFlowField = nullptr;
 	mCurrentNode = mNodeGraph->GetClosestNode(mPosition);
-	mPointPath = AStarSearch(this, mCurrentNode, destination, mCurrentWorld->GetObstacles());
+
+	// The path arrives on a later update, keep following the current one until then
+	PathScheduler* scheduler = mCurrentWorld->GetPathScheduler();
+	if (mPathRequest != -1) { scheduler->Cancel(mPathRequest); }
+	mPathRequest = scheduler->RequestPath(mPosition, mEndPos, mCurrentNode, destination, mRadius);
 }
 
 void PathAgent::GoTo(Vec2 pos)
 {
 	mEndPos = pos;
-	Node* end = mNodeGraph->GetClosestNode(pos);
+	int end = mNodeGraph->GetClosestNode(pos);
 	GoToNode(end);
 }
 
+void PathAgent::FollowFlowField(const FlowField* flowField)
+{
+	if (mPathRequest != -1)
+	{
+		mCurrentWorld->GetPathScheduler()->Cancel(mPathRequest);
+		mPathRequest = -1;
+	}
+
+	mPointPath.clear();
+	mEndPos = flowField->GetGoal();
+	mCurrentNode = mNodeGraph->GetClosestNode(mPosition);
+	mFlowField = flowField;
+}
+
 void PathAgent::SetColour(const char* colour)
 {
 	if (colour == "CYAN")
@@ -4,23 +4,29 @@
 #include "Vec2.h"
 #include "Colour.h"
 #include "NodeGraph.h"
-#include "Node.h"
 #include <vector>
 
 class World;
 class LineRenderer;
+class FlowField;
 
 class PathAgent
 {
 protected:
 	Vec2 mPosition;
 	float mSpeed = 1000;
-	Node* mCurrentNode;
-	NodeGraph* mNodeGraph;
+	int mCurrentNode = -1;
+	const NodeGraph* mNodeGraph;
 	World* mCurrentWorld;
-	std::vector<Node*> mNodePath;
+	std::vector<int> mNodePath;
 	std::vector<Vec2> mPointPath;
 
+	// Path being worked out by the world's scheduler, -1 if there isn't one
+	int mPathRequest = -1;
+
+	// Shared field being followed instead of a path, nullptr when following a path
+	const FlowField* mFlowField = nullptr;
+
 	Colour mColour;
 	int mCurrentIndex;
 	float mRadius = 0;
@@ -32,16 +38,19 @@ protected:
 
 
 public:
-	PathAgent(NodeGraph* nodeGraph, float width, Colour colour, World* world);
+	PathAgent(const NodeGraph* nodeGraph, float width, Colour colour, World* world);
 
 	virtual void Update(float deltaTime);
 	void Draw(LineRenderer* lines);
 
 	void NavigateNodePath(float deltaTime);
 	void NavigatePointPath(float deltaTime);
+	void NavigateFlowField(float deltaTime);
 
-	void GoToNode(Node* destination);
+	void GoToNode(int destination);
 	void GoTo(Vec2 pos);
+	// Heads for the field's goal, the field has to stay alive until the agent arrives or is given somewhere else to go
+	void FollowFlowField(const FlowField* flowField);
 
 	void SetSpeed(float speed) { mSpeed = speed; }
 	void SetColour(const char* colour);
@@ -51,10 +60,8 @@ public:
 	Vec2 GetPosition() { return mPosition; }
 	Vec2 GetEndPos() { return mEndPos; }
 
-	void AddPortalLeft(Vec2 portal) { portalLeft.push_back(portal); }
-	void AddPortalRight(Vec2 portal) { portalRight.push_back(portal); }
-	void ClearPortals() { portalLeft.clear(); portalRight.clear(); }
 	World* GetWorld() { return mCurrentWorld; }
+	const NodeGraph* GetNodeGraph() const { return mNodeGraph; }
 	std::vector<std::vector<Vec2>> pathedges;
 	std::vector<Vec2> GetPath() { return mPointPath; }
 
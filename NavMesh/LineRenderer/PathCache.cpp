@@ -0,0 +1,131 @@
+#include "PathCache.h"
+
+#include "NavigationMesh.h"
+#include "SearchContext.h"
+#include <algorithm>
+
+PathCache::PathCache(const NavigationMesh* navMesh, int capacity, float radiusClassSize)
+	: mNavMesh(navMesh), mVersion(navMesh->GetVersion()), mCapacity(capacity), mRadiusClassSize(radiusClassSize)
+{
+}
+
+bool PathCache::Find(int startNode, int endNode, float radius, SearchContext& context)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	CheckVersion();
+
+	auto found = mLookup.find(MakeKey(startNode, endNode, radius));
+	if (found == mLookup.end())
+	{
+		mMisses++;
+		return false;
+	}
+
+	mHits++;
+	mEntries.splice(mEntries.begin(), mEntries, found->second);
+	context.SetPath(found->second->nodes);
+	return true;
+}
+
+void PathCache::Add(int startNode, int endNode, float radius, const SearchContext& context)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mCapacity <= 0) { return; }
+	CheckVersion();
+
+	Key key = MakeKey(startNode, endNode, radius);
+	auto found = mLookup.find(key);
+	if (found != mLookup.end())
+	{
+		mEntries.splice(mEntries.begin(), mEntries, found->second);
+		found->second->nodes = context.GetPath();
+		return;
+	}
+
+	// Reuse the least recently used entry when full rather than allocating a new one
+	if ((int)mEntries.size() >= mCapacity)
+	{
+		mLookup.erase(mEntries.back().key);
+		mEntries.splice(mEntries.begin(), mEntries, std::prev(mEntries.end()));
+	}
+	else { mEntries.emplace_front(); }
+
+	mEntries.front().key = key;
+	mEntries.front().nodes = context.GetPath();
+	mLookup[key] = mEntries.begin();
+}
+
+void PathCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mEntries.clear();
+	mLookup.clear();
+}
+
+void PathCache::SetCapacity(int capacity)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mCapacity = capacity;
+	Trim();
+}
+
+int PathCache::GetCapacity() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCapacity;
+}
+
+int PathCache::GetSize() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return (int)mEntries.size();
+}
+
+int PathCache::GetHits() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mHits;
+}
+
+int PathCache::GetMisses() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mMisses;
+}
+
+void PathCache::ResetCounters()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mHits = 0;
+	mMisses = 0;
+}
+
+size_t PathCache::KeyHash::operator()(const Key& key) const
+{
+	size_t hash = std::hash<int>()(key.startNode);
+	hash = hash * 31 + std::hash<int>()(key.endNode);
+	return hash * 31 + std::hash<int>()(key.radiusClass);
+}
+
+PathCache::Key PathCache::MakeKey(int startNode, int endNode, float radius) const
+{
+	return { startNode, endNode, (int)(radius / mRadiusClassSize) };
+}
+
+void PathCache::CheckVersion()
+{
+	if (mVersion == mNavMesh->GetVersion()) { return; }
+
+	mVersion = mNavMesh->GetVersion();
+	mEntries.clear();
+	mLookup.clear();
+}
+
+void PathCache::Trim()
+{
+	while ((int)mEntries.size() > std::max(mCapacity, 0))
+	{
+		mLookup.erase(mEntries.back().key);
+		mEntries.pop_back();
+	}
+}
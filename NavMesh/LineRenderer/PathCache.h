@@ -0,0 +1,79 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class NavigationMesh;
+class SearchContext;
+
+// Remembers the node paths of recent searches, so requests between the same nodes only have to be string pulled
+// Paths are keyed by start node, end node and radius class, and the least recently used path is dropped when it is full
+// Everything is thrown away once the navigation mesh is rebuilt. Safe to share between threads
+class PathCache
+{
+	struct Key
+	{
+		int startNode;
+		int endNode;
+		int radiusClass;
+
+		bool operator==(const Key& other) const
+		{
+			return startNode == other.startNode && endNode == other.endNode && radiusClass == other.radiusClass;
+		}
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	struct Entry
+	{
+		Key key;
+		std::vector<int> nodes;
+	};
+
+	const NavigationMesh* mNavMesh;
+	// Version of the mesh the cached paths were found on
+	int mVersion;
+
+	// Most recently used first
+	std::list<Entry> mEntries;
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> mLookup;
+	int mCapacity;
+
+	// Radii are rounded down to a multiple of this, agents in the same class share paths
+	float mRadiusClassSize;
+
+	int mHits = 0;
+	int mMisses = 0;
+
+	mutable std::mutex mMutex;
+
+public:
+	PathCache(const NavigationMesh* navMesh, int capacity = 256, float radiusClassSize = 10.0f);
+
+	// Copies the cached node path into the context's path, ready for string pulling. Returns false if it isn't cached
+	bool Find(int startNode, int endNode, float radius, SearchContext& context);
+	// Stores the node path left in the context by a successful search
+	void Add(int startNode, int endNode, float radius, const SearchContext& context);
+	void Clear();
+
+	// Shrinking drops the least recently used paths
+	void SetCapacity(int capacity);
+	int GetCapacity() const;
+	int GetSize() const;
+
+	int GetHits() const;
+	int GetMisses() const;
+	void ResetCounters();
+
+private:
+	Key MakeKey(int startNode, int endNode, float radius) const;
+	// Empties the cache if the mesh has been rebuilt since the paths were found, the mutex has to be held
+	void CheckVersion();
+	void Trim();
+};
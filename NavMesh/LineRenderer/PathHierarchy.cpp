@@ -0,0 +1,218 @@
+#include "PathHierarchy.h"
+
+#include "NodeGraph.h"
+#include "SearchContext.h"
+#include "NavigationUtilities.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+PathHierarchy::PathHierarchy(const NodeGraph* graph, float clusterSize) : mGraph(graph), mClusterSize(clusterSize)
+{
+	Build();
+}
+
+void PathHierarchy::Build()
+{
+	int nodeCount = mGraph->GetNodeCount();
+	mNodeClusters.assign(nodeCount, -1);
+	mClusterNodes.clear();
+	mClusterEntrances.clear();
+	mAbstractEdges.assign(nodeCount, {});
+	if (nodeCount == 0) { return; }
+
+	Vec2 min = mGraph->GetPosition(0);
+	Vec2 max = min;
+	for (int node = 1; node < nodeCount; node++)
+	{
+		const Vec2& position = mGraph->GetPosition(node);
+		min = Vec2(std::min(min.x, position.x), std::min(min.y, position.y));
+		max = Vec2(std::max(max.x, position.x), std::max(max.y, position.y));
+	}
+
+	mOrigin = min;
+	mColumns = (int)((max.x - min.x) / mClusterSize) + 1;
+	mRows = (int)((max.y - min.y) / mClusterSize) + 1;
+	mClusterNodes.resize(mColumns * mRows);
+	mClusterEntrances.resize(mColumns * mRows);
+
+	for (int node = 0; node < nodeCount; node++)
+	{
+		const Vec2& position = mGraph->GetPosition(node);
+		int column = std::min((int)((position.x - mOrigin.x) / mClusterSize), mColumns - 1);
+		int row = std::min((int)((position.y - mOrigin.y) / mClusterSize), mRows - 1);
+		mNodeClusters[node] = row * mColumns + column;
+		mClusterNodes[mNodeClusters[node]].push_back(node);
+	}
+
+	SearchContext context;
+	for (int cluster = 0; cluster < GetClusterCount(); cluster++)
+	{
+		BuildCluster(context, cluster);
+	}
+}
+
+int PathHierarchy::GetEntranceCount() const
+{
+	int entranceCount = 0;
+	for (const std::vector<int>& entrances : mClusterEntrances)
+	{
+		entranceCount += (int)entrances.size();
+	}
+	return entranceCount;
+}
+
+bool PathHierarchy::FindNodePath(SearchContext& context, int startNode, int endNode) const
+{
+	if (startNode == -1 || endNode == -1 || !mGraph->AreConnected(startNode, endNode))
+	{
+		context.Reset(mGraph->GetNodeCount(), endNode);
+		return false;
+	}
+
+	// Short paths gain nothing from going through the entrances
+	int startCluster = mNodeClusters[startNode];
+	int endCluster = mNodeClusters[endNode];
+	if (abs(startCluster % mColumns - endCluster % mColumns) <= 1 && abs(startCluster / mColumns - endCluster / mColumns) <= 1)
+	{
+		return ::FindNodePath(*mGraph, context, startNode, endNode);
+	}
+
+	// Costs between the end and the entrances of its cluster, then between the start and the entrances of its cluster,
+	// each searched without leaving that cluster. Connections cost the same both ways
+	std::vector<std::pair<int, float>> endCosts;
+	SearchCluster(context, endNode, -1);
+	for (int entrance : mClusterEntrances[mNodeClusters[endNode]])
+	{
+		if (context.IsClosed(entrance)) { endCosts.push_back({ entrance, context.GetGScore(entrance) }); }
+	}
+
+	std::vector<std::pair<int, float>> startCosts;
+	SearchCluster(context, startNode, -1);
+	for (int entrance : mClusterEntrances[mNodeClusters[startNode]])
+	{
+		if (context.IsClosed(entrance)) { startCosts.push_back({ entrance, context.GetGScore(entrance) }); }
+	}
+
+	// A* over the coarse graph, with the start and end joined on to it
+	context.Reset(mGraph->GetNodeCount(), endNode);
+	context.Open(startNode, 0, mGraph->EstimateCost(startNode, endNode), -1);
+	bool found = false;
+	while (!context.IsOpenEmpty())
+	{
+		int currentNode = context.PopLowest();
+		float currentScore = context.GetGScore(currentNode);
+		if (currentNode == endNode)
+		{
+			found = true;
+			break;
+		}
+
+		auto open = [&](int target, float cost)
+		{
+			if (context.IsClosed(target)) { return; }
+			float gScore = currentScore + cost;
+			context.Open(target, gScore, gScore + mGraph->EstimateCost(target, endNode), currentNode);
+		};
+
+		if (currentNode == startNode)
+		{
+			for (const std::pair<int, float>& startCost : startCosts) { open(startCost.first, startCost.second); }
+		}
+		for (const AbstractEdge& edge : mAbstractEdges[currentNode]) { open(edge.target, edge.cost); }
+		for (const std::pair<int, float>& endCost : endCosts)
+		{
+			if (endCost.first == currentNode) { open(endNode, endCost.second); }
+		}
+	}
+
+	if (!found)
+	{
+		context.GetPath().clear();
+		return false;
+	}
+
+	// Fill in the nodes between each pair of coarse nodes, which are either side of a cluster border or in the same cluster
+	context.BuildPath(endNode);
+	std::vector<int> abstractPath = context.GetPath();
+	std::vector<int> path = { startNode };
+	for (size_t i = 0; i + 1 < abstractPath.size(); i++)
+	{
+		int from = abstractPath[i];
+		int to = abstractPath[i + 1];
+		if (mNodeClusters[from] != mNodeClusters[to])
+		{
+			path.push_back(to);
+			continue;
+		}
+
+		SearchCluster(context, from, to);
+		context.BuildPath(to);
+		path.insert(path.end(), context.GetPath().begin() + 1, context.GetPath().end());
+	}
+
+	context.SetPath(path);
+	return true;
+}
+
+void PathHierarchy::BuildCluster(SearchContext& context, int cluster)
+{
+	std::vector<int>& entrances = mClusterEntrances[cluster];
+	for (int entrance : entrances)
+	{
+		mAbstractEdges[entrance].clear();
+	}
+	entrances.clear();
+
+	for (int node : mClusterNodes[cluster])
+	{
+		bool isEntrance = false;
+		for (int edge = mGraph->GetEdgeStart(node); edge < mGraph->GetEdgeEnd(node); edge++)
+		{
+			int target = mGraph->GetEdgeTarget(edge);
+			if (mNodeClusters[target] == cluster) { continue; }
+
+			mAbstractEdges[node].push_back({ target, mGraph->GetEdgeCost(edge) });
+			isEntrance = true;
+		}
+
+		if (isEntrance) { entrances.push_back(node); }
+	}
+
+	// Shortest path between every pair of entrances that can reach each other inside the cluster
+	for (int entrance : entrances)
+	{
+		SearchCluster(context, entrance, -1);
+		for (int other : entrances)
+		{
+			if (other != entrance && context.IsClosed(other))
+			{
+				mAbstractEdges[entrance].push_back({ other, context.GetGScore(other) });
+			}
+		}
+	}
+}
+
+void PathHierarchy::SearchCluster(SearchContext& context, int startNode, int endNode) const
+{
+	int cluster = mNodeClusters[startNode];
+	context.Reset(mGraph->GetNodeCount(), endNode);
+	context.Open(startNode, 0, endNode == -1 ? 0 : mGraph->EstimateCost(startNode, endNode), -1);
+
+	while (!context.IsOpenEmpty())
+	{
+		int currentNode = context.PopLowest();
+		if (currentNode == endNode) { return; }
+		float currentScore = context.GetGScore(currentNode);
+
+		for (int edge = mGraph->GetEdgeStart(currentNode); edge < mGraph->GetEdgeEnd(currentNode); edge++)
+		{
+			int target = mGraph->GetEdgeTarget(edge);
+			if (mNodeClusters[target] != cluster || context.IsClosed(target)) { continue; }
+
+			float gScore = currentScore + mGraph->GetEdgeCost(edge);
+			float hScore = endNode == -1 ? 0 : mGraph->EstimateCost(target, endNode);
+			context.Open(target, gScore, gScore + hScore, currentNode);
+		}
+	}
+}
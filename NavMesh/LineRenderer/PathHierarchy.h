@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Vec2.h"
+#include <vector>
+
+class NodeGraph;
+class SearchContext;
+
+// A coarser graph over the node graph for long searches (hierarchical A*)
+// Nodes are grouped into square clusters by position. Nodes with a connection into another cluster are entrances, and the
+// coarse graph joins the entrances of each cluster with the cost of the shortest path between them inside the cluster
+// A search crosses the map on the coarse graph first, then only searches inside the clusters along the way
+// Only read once it is built, so any number of threads can search it at the same time
+class PathHierarchy
+{
+	// A connection in the coarse graph, between two entrances or across a cluster border
+	struct AbstractEdge
+	{
+		int target;
+		float cost;
+	};
+
+	const NodeGraph* mGraph;
+
+	// Clusters are laid out in a grid starting at the origin
+	float mClusterSize;
+	Vec2 mOrigin;
+	int mColumns = 0;
+	int mRows = 0;
+
+	std::vector<int> mNodeClusters;
+	std::vector<std::vector<int>> mClusterNodes;
+	std::vector<std::vector<int>> mClusterEntrances;
+	// Coarse graph connections leaving each node, empty for nodes that aren't entrances
+	std::vector<std::vector<AbstractEdge>> mAbstractEdges;
+
+public:
+	PathHierarchy(const NodeGraph* graph, float clusterSize);
+
+	// Puts every node in a cluster and builds the coarse graph
+	void Build();
+
+	int GetClusterCount() const { return (int)mClusterNodes.size(); }
+	int GetNodeCluster(int node) const { return mNodeClusters[node]; }
+	int GetEntranceCount() const;
+
+	// Same as the FindNodePath in NavigationUtilities, leaving the nodes of the path in the context
+	// Paths between the same or neighbouring clusters are searched on the node graph
+	bool FindNodePath(SearchContext& context, int startNode, int endNode) const;
+
+private:
+	// Works out the entrances and coarse graph connections of one cluster, the context is shared between clusters
+	void BuildCluster(SearchContext& context, int cluster);
+	// Searches from the start without leaving its cluster. Stops at the end node, or covers the whole cluster when it is -1
+	void SearchCluster(SearchContext& context, int startNode, int endNode) const;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Vec2.h"
+#include "SearchContext.h"
+#include <vector>
+
+// Where a time sliced path search is up to
+enum class PathSearchStatus
+{
+	IN_PROGRESS,
+	COMPLETE,
+	// Stopped early, the path goes as close to the end as the search got
+	PARTIAL,
+	FAILED
+};
+
+// One path request along with everything searching for it writes to
+// The graph and obstacles are only read while searching, so queries can run on as many threads at once as there are
+// PathQuery objects. Keep one around between requests to reuse its memory
+struct PathQuery
+{
+	// Where the path goes from and to, and the nodes those positions are in
+	Vec2 mStart;
+	Vec2 mEnd;
+	int mStartNode = -1;
+	int mEndNode = -1;
+	// How far the path keeps away from corners
+	float mRadius = 0;
+	// When the end can't be reached from the start, go to the closest point that can be instead. mEnd and mEndNode are
+	// moved there
+	bool mRedirectUnreachable = false;
+
+	// Limits for time sliced searches, anything left at 0 is ignored
+	// Most nodes expanded and microseconds spent in one call to ContinuePathSearch
+	int mSliceExpansions = 0;
+	int mSliceMicroseconds = 0;
+	// Microseconds of searching in total before the search is stopped
+	int mTimeLimit = 0;
+	// When a search is stopped, path to the explored node closest to the end rather than failing. mEnd is moved there
+	bool mAllowPartialPath = false;
+	// Microseconds spent on the current search so far
+	float mSearchTime = 0;
+
+	// The finished path, empty if the end couldn't be reached
+	std::vector<Vec2> mPath;
+
+	// Node search state and the resulting list of nodes
+	SearchContext mSearch;
+
+	// Polygon edges crossed along the node path, from the start
+	std::vector<std::vector<Vec2>> mPortals;
+
+	// DEBUG
+	// Portal ends after pulling them in by the radius
+	std::vector<Vec2> mPortalLefts;
+	std::vector<Vec2> mPortalRights;
+};
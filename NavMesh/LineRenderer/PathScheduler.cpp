@@ -0,0 +1,297 @@
+#include "PathScheduler.h"
+
+#include "NodeGraph.h"
+#include "PathQuery.h"
+#include "NavigationUtilities.h"
+#include "PathHierarchy.h"
+#include <algorithm>
+#include <chrono>
+
+PathScheduler::PathScheduler(const NodeGraph* graph, const std::vector<Obstacle*>* obstacles, int threadCount)
+	: mGraph(graph), mObstacles(obstacles), mPathCache(graph->GetNavMesh())
+{
+	if (threadCount == MAIN_THREAD) { mSliceQuery = std::make_unique<PathQuery>(); }
+	else { mThreadPool = std::make_unique<ThreadPool>(threadCount); }
+}
+
+PathScheduler::~PathScheduler()
+{
+	if (mThreadPool) { mThreadPool->Wait(); }
+}
+
+int PathScheduler::RequestPath(const Vec2& start, const Vec2& end, int startNode, int endNode, float radius)
+{
+	Request request;
+	request.mHandle = mNextHandle++;
+	request.mStart = start;
+	request.mEnd = end;
+	request.mStartNode = startNode;
+	request.mEndNode = endNode;
+	request.mRadius = radius;
+
+	// Done here rather than on the workers, so requests going to the same place still end up next to each other
+	if (mRedirectUnreachable && startNode != -1 && endNode != -1 && !mGraph->AreConnected(startNode, endNode))
+	{
+		request.mEnd = mGraph->FindClosestPointInComponent(mGraph->GetComponent(startNode), end, request.mEndNode);
+	}
+
+	mPending.push_back(request);
+	mLiveHandles.insert(request.mHandle);
+	return request.mHandle;
+}
+
+void PathScheduler::Cancel(int handle)
+{
+	// Anything still queued or running is dropped when it is next seen
+	mLiveHandles.erase(handle);
+	mResults.erase(handle);
+}
+
+bool PathScheduler::Stop(int handle)
+{
+	if (!mSearching || mSliceQueue.front().mHandle != handle || mLiveHandles.count(handle) == 0) { return false; }
+
+	PathSearchStatus status = StopPathSearch(*mGraph, *mObstacles, *mSliceQuery);
+	Request& request = mSliceQueue.front();
+	request.mFound = status == PathSearchStatus::PARTIAL;
+	request.mPartial = request.mFound;
+	request.mPath = mSliceQuery->mPath;
+	Finish(request);
+	mSliceQueue.pop_front();
+	mSearching = false;
+	return true;
+}
+
+void PathScheduler::Update()
+{
+	// Hand back what the workers have finished, keeping the rest for the next update
+	{
+		std::lock_guard<std::mutex> lock(mFinishedMutex);
+		for (int delivered = 0; delivered < mCompletionBudget && !mFinished.empty(); delivered++)
+		{
+			Request& request = mFinished.front();
+			if (mLiveHandles.count(request.mHandle) != 0)
+			{
+				mResults[request.mHandle] = { request.mFound, request.mPartial, std::move(request.mPath) };
+			}
+			mFinished.pop_front();
+		}
+	}
+
+	// Requests cancelled before they started are never searched
+	mPending.erase(std::remove_if(mPending.begin(), mPending.end(), [this](const Request& r) { return mLiveHandles.count(r.mHandle) == 0; }), mPending.end());
+	if (mPending.empty())
+	{
+		if (!mThreadPool) { RunSlices(); }
+		return;
+	}
+
+	// Sorting puts requests between the same nodes together so they can share a search
+	std::shared_ptr<std::vector<Request>> batch = std::make_shared<std::vector<Request>>(std::move(mPending));
+	mPending.clear();
+	std::sort(batch->begin(), batch->end(), [](const Request& a, const Request& b)
+	{
+		return a.mStartNode != b.mStartNode ? a.mStartNode < b.mStartNode : a.mEndNode < b.mEndNode;
+	});
+
+	if (!mThreadPool)
+	{
+		// Searched after anything already waiting, in the order they were sorted
+		mSliceQueue.insert(mSliceQueue.end(), std::make_move_iterator(batch->begin()), std::make_move_iterator(batch->end()));
+		RunSlices();
+		return;
+	}
+
+	// Split into a few jobs per worker, only ever between node pairs
+	int batchSize = (int)batch->size();
+	int jobSize = std::max(1, batchSize / (mThreadPool->GetThreadCount() * 4));
+	int start = 0;
+	while (start < batchSize)
+	{
+		int end = std::min(start + jobSize, batchSize);
+		while (end < batchSize && (*batch)[end].mStartNode == (*batch)[end - 1].mStartNode && (*batch)[end].mEndNode == (*batch)[end - 1].mEndNode)
+		{
+			end++;
+		}
+
+		mThreadPool->Submit([this, batch, start, end, hierarchy = mHierarchy]() { RunBatch(*batch, start, end, hierarchy); });
+		start = end;
+	}
+}
+
+PathRequestStatus PathScheduler::GetStatus(int handle) const
+{
+	if (mLiveHandles.count(handle) == 0) { return PathRequestStatus::INVALID; }
+
+	auto result = mResults.find(handle);
+	if (result == mResults.end()) { return PathRequestStatus::PENDING; }
+
+	if (!result->second.mFound) { return PathRequestStatus::FAILED; }
+	return result->second.mPartial ? PathRequestStatus::PARTIAL : PathRequestStatus::COMPLETE;
+}
+
+bool PathScheduler::TakePath(int handle, std::vector<Vec2>& path)
+{
+	auto result = mResults.find(handle);
+	if (result == mResults.end()) { return false; }
+
+	path = std::move(result->second.mPath);
+	mResults.erase(result);
+	mLiveHandles.erase(handle);
+	return true;
+}
+
+void PathScheduler::RunBatch(std::vector<Request>& batch, int start, int end, const PathHierarchy* hierarchy)
+{
+	std::unique_ptr<PathQuery> query;
+	{
+		std::lock_guard<std::mutex> lock(mQueryMutex);
+		if (!mSpareQueries.empty())
+		{
+			query = std::move(mSpareQueries.back());
+			mSpareQueries.pop_back();
+		}
+	}
+	if (!query) { query = std::make_unique<PathQuery>(); }
+
+	bool found = false;
+	for (int i = start; i < end; i++)
+	{
+		Request& request = batch[i];
+		bool sameNodes = i > start && request.mStartNode == batch[i - 1].mStartNode && request.mEndNode == batch[i - 1].mEndNode;
+
+		if (!sameNodes)
+		{
+			found = request.mStartNode != -1 && request.mEndNode != -1;
+			if (found && !mPathCache.Find(request.mStartNode, request.mEndNode, request.mRadius, query->mSearch))
+			{
+				found = hierarchy ? hierarchy->FindNodePath(query->mSearch, request.mStartNode, request.mEndNode) :
+					FindNodePath(*mGraph, query->mSearch, request.mStartNode, request.mEndNode);
+				if (found) { mPathCache.Add(request.mStartNode, request.mEndNode, request.mRadius, query->mSearch); }
+			}
+		}
+
+		request.mFound = found;
+		if (!found) { continue; }
+
+		// The same request twice only needs pulling once
+		if (sameNodes && request.mStart == batch[i - 1].mStart && request.mEnd == batch[i - 1].mEnd && request.mRadius == batch[i - 1].mRadius)
+		{
+			request.mPath = batch[i - 1].mPath;
+			continue;
+		}
+
+		query->mStart = request.mStart;
+		query->mEnd = request.mEnd;
+		query->mRadius = request.mRadius;
+		StringPull(*mGraph, *mObstacles, *query);
+		request.mPath = query->mPath;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mFinishedMutex);
+		for (int i = start; i < end; i++)
+		{
+			mFinished.push_back(std::move(batch[i]));
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mQueryMutex);
+	mSpareQueries.push_back(std::move(query));
+}
+
+void PathScheduler::RunSlices()
+{
+	auto frameStart = std::chrono::steady_clock::now();
+	int expansionsLeft = mFrameExpansions;
+
+	while (!mSliceQueue.empty())
+	{
+		Request& request = mSliceQueue.front();
+
+		// Cancelled while waiting or part way through
+		if (mLiveHandles.count(request.mHandle) == 0)
+		{
+			mSliceQueue.pop_front();
+			mSearching = false;
+			continue;
+		}
+
+		if (!mSearching)
+		{
+			if (request.mStartNode == -1 || request.mEndNode == -1)
+			{
+				Finish(request);
+				mSliceQueue.pop_front();
+				continue;
+			}
+
+			mSliceQuery->mStart = request.mStart;
+			mSliceQuery->mEnd = request.mEnd;
+			mSliceQuery->mStartNode = request.mStartNode;
+			mSliceQuery->mEndNode = request.mEndNode;
+			mSliceQuery->mRadius = request.mRadius;
+			mSliceQuery->mTimeLimit = mSearchTimeLimit;
+			mSliceQuery->mAllowPartialPath = mAllowPartialPaths;
+
+			if (mPathCache.Find(request.mStartNode, request.mEndNode, request.mRadius, mSliceQuery->mSearch))
+			{
+				StringPull(*mGraph, *mObstacles, *mSliceQuery);
+				request.mFound = true;
+				request.mPath = mSliceQuery->mPath;
+				Finish(request);
+				mSliceQueue.pop_front();
+				continue;
+			}
+
+			StartPathSearch(*mGraph, *mSliceQuery);
+			mSearching = true;
+		}
+
+		// Only search for whatever is left of the frame
+		int elapsed = (int)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frameStart).count();
+		if (mFrameMicroseconds > 0 && elapsed >= mFrameMicroseconds) { return; }
+		mSliceQuery->mSliceMicroseconds = mFrameMicroseconds > 0 ? mFrameMicroseconds - elapsed : 0;
+		mSliceQuery->mSliceExpansions = expansionsLeft;
+
+		int expansions = mSliceQuery->mSearch.GetExpansions();
+		PathSearchStatus status = ContinuePathSearch(*mGraph, *mObstacles, *mSliceQuery);
+		expansionsLeft -= mSliceQuery->mSearch.GetExpansions() - expansions;
+		if (status == PathSearchStatus::IN_PROGRESS) { return; }
+
+		mSearching = false;
+		request.mFound = status == PathSearchStatus::COMPLETE || status == PathSearchStatus::PARTIAL;
+		request.mPartial = status == PathSearchStatus::PARTIAL;
+		request.mPath = mSliceQuery->mPath;
+		if (status == PathSearchStatus::COMPLETE) { mPathCache.Add(request.mStartNode, request.mEndNode, request.mRadius, mSliceQuery->mSearch); }
+		int startNode = request.mStartNode;
+		int endNode = request.mEndNode;
+		Finish(request);
+		mSliceQueue.pop_front();
+
+		// Requests between the same nodes waiting right behind use the same node path
+		while (status == PathSearchStatus::COMPLETE && !mSliceQueue.empty() && mSliceQueue.front().mStartNode == startNode && mSliceQueue.front().mEndNode == endNode)
+		{
+			Request& next = mSliceQueue.front();
+			if (mLiveHandles.count(next.mHandle) != 0)
+			{
+				mSliceQuery->mStart = next.mStart;
+				mSliceQuery->mEnd = next.mEnd;
+				mSliceQuery->mRadius = next.mRadius;
+				StringPull(*mGraph, *mObstacles, *mSliceQuery);
+				next.mFound = true;
+				next.mPath = mSliceQuery->mPath;
+				Finish(next);
+			}
+			mSliceQueue.pop_front();
+		}
+
+		if (mFrameExpansions > 0 && expansionsLeft <= 0) { return; }
+	}
+}
+
+void PathScheduler::Finish(Request& request)
+{
+	std::lock_guard<std::mutex> lock(mFinishedMutex);
+	mFinished.push_back(std::move(request));
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Vec2.h"
+#include "ThreadPool.h"
+#include "PathCache.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class NodeGraph;
+class PathHierarchy;
+class Obstacle;
+struct PathQuery;
+
+enum class PathRequestStatus
+{
+	// The handle was never given out, was cancelled, or its path has already been taken
+	INVALID,
+	PENDING,
+	COMPLETE,
+	// The search was stopped at the time limit, the path only goes as far as the search got
+	PARTIAL,
+	FAILED
+};
+
+// Runs path requests on worker threads so asking for a path never stalls the frame
+// Requests made during a frame are started together on the next Update, and the finished paths are handed back on a
+// later Update. Requests between the same two nodes share one search
+// Without worker threads the searches run inside Update instead, a slice at a time within a per frame budget
+class PathScheduler
+{
+	struct Request
+	{
+		int mHandle;
+		Vec2 mStart;
+		Vec2 mEnd;
+		int mStartNode;
+		int mEndNode;
+		float mRadius;
+
+		bool mFound = false;
+		bool mPartial = false;
+		std::vector<Vec2> mPath;
+	};
+
+	struct Result
+	{
+		bool mFound;
+		bool mPartial;
+		std::vector<Vec2> mPath;
+	};
+
+	const NodeGraph* mGraph = nullptr;
+	const std::vector<Obstacle*>* mObstacles = nullptr;
+
+	// Everything below is only touched on the thread that calls Update, apart from the finished list and spare queries
+	int mNextHandle = 0;
+	// Requested and not yet handed back or cancelled
+	std::unordered_set<int> mLiveHandles;
+	// Waiting for the next Update to start them
+	std::vector<Request> mPending;
+	// Finished and waiting for the owner to take them
+	std::unordered_map<int, Result> mResults;
+
+	// Most results handed back per Update
+	int mCompletionBudget = 64;
+
+	// Requests for ends that can't be reached go to the closest point that can be instead of failing
+	bool mRedirectUnreachable = false;
+
+	// Node paths of recent searches, shared by every request
+	PathCache mPathCache;
+
+	// Searched instead of the node graph by the worker threads when set, jobs keep the one set when they were started
+	const PathHierarchy* mHierarchy = nullptr;
+
+	// Main thread searching, the requests waiting their turn with the one being searched at the front
+	std::deque<Request> mSliceQueue;
+	std::unique_ptr<PathQuery> mSliceQuery;
+	bool mSearching = false;
+	// Searching done per Update, limits of 0 are ignored
+	int mFrameExpansions = 0;
+	int mFrameMicroseconds = 2000;
+	// Microseconds one request can search for in total, spread over as many frames as it takes
+	int mSearchTimeLimit = 0;
+	// Requests that hit the time limit get a path part of the way instead of failing
+	bool mAllowPartialPaths = false;
+
+	// Filled by the workers
+	std::mutex mFinishedMutex;
+	std::deque<Request> mFinished;
+
+	// One query per worker at a time, reused so the workers don't allocate search state
+	std::mutex mQueryMutex;
+	std::vector<std::unique_ptr<PathQuery>> mSpareQueries;
+
+	// Last, so the workers are stopped before anything they use is destroyed. Not made when searching on the main thread
+	std::unique_ptr<ThreadPool> mThreadPool;
+
+public:
+	// Thread count that runs the searches inside Update rather than on worker threads
+	static const int MAIN_THREAD = -1;
+
+	// The graph and obstacles have to outlive the scheduler. A thread count of 0 uses one thread per core
+	PathScheduler(const NodeGraph* graph, const std::vector<Obstacle*>* obstacles, int threadCount = 0);
+
+	~PathScheduler();
+	PathScheduler(const PathScheduler& other) = delete;
+	PathScheduler& operator=(const PathScheduler& other) = delete;
+
+	// Queues a path from start to end, the nodes are the ones the positions are in. Returns the handle to collect it with
+	int RequestPath(const Vec2& start, const Vec2& end, int startNode, int endNode, float radius);
+	// Drops the request, its path is thrown away if it is already being searched
+	void Cancel(int handle);
+	// Ends the search now when it is the one being searched on the main thread, handing back a partial path if they are
+	// allowed. Returns false if the request isn't being searched
+	bool Stop(int handle);
+
+	// Call once a frame. Hands back up to the completion budget of finished paths, then starts everything requested since
+	// On the main thread it then searches until the frame budget is used up, carrying on from there next Update
+	void Update();
+
+	PathRequestStatus GetStatus(int handle) const;
+	// Moves the path of a finished request out, after which the handle is no longer valid. Returns false if it isn't finished
+	bool TakePath(int handle, std::vector<Vec2>& path);
+
+	void SetRedirectUnreachable(bool redirect) { mRedirectUnreachable = redirect; }
+	bool GetRedirectUnreachable() const { return mRedirectUnreachable; }
+
+	void SetCompletionBudget(int budget) { mCompletionBudget = budget; }
+	int GetCompletionBudget() const { return mCompletionBudget; }
+
+	// For setting the capacity and reading the hit and miss counts
+	PathCache& GetPathCache() { return mPathCache; }
+
+	// The hierarchy has to be built on the same graph and outlive the scheduler. Time sliced searches on the main thread
+	// always use the node graph, so they can stop part way
+	void SetHierarchy(const PathHierarchy* hierarchy) { mHierarchy = hierarchy; }
+
+	// Only used when searching on the main thread
+	void SetFrameBudget(int expansions, int microseconds) { mFrameExpansions = expansions; mFrameMicroseconds = microseconds; }
+	void SetSearchTimeLimit(int microseconds, bool allowPartialPaths) { mSearchTimeLimit = microseconds; mAllowPartialPaths = allowPartialPaths; }
+
+private:
+	// Runs requests [start, end) of a batch, which are sorted so requests between the same nodes are next to each other
+	void RunBatch(std::vector<Request>& batch, int start, int end, const PathHierarchy* hierarchy);
+	// Searches the queued requests on the main thread until the frame budget runs out
+	void RunSlices();
+	// Passes a request on to be handed back
+	void Finish(Request& request);
+};
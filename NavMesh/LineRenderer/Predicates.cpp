@@ -0,0 +1,316 @@
+#include "Predicates.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+// Half of the gap between 1 and the next double, the most a single rounding can be off by
+static const double sEpsilon = DBL_EPSILON * 0.5;
+// Used to split a double into two halves that can be multiplied without rounding
+static const double sSplitter = 134217729.0;
+
+static const double sOrientErrorBound = (3.0 + 16.0 * sEpsilon) * sEpsilon;
+static const double sInCircleErrorBound = (10.0 + 96.0 * sEpsilon) * sEpsilon;
+
+// Largest expansions the exact tests can make
+static const int sMaxScaled = 32;
+static const int sMaxProduct = 512;
+
+// Expansions are lists of doubles in increasing order of size that add up to the exact value with no overlapping bits
+// The largest term (the last one) always has the sign of the whole expansion
+
+// a + b = x + y exactly
+static void TwoSum(double a, double b, double& x, double& y)
+{
+	x = a + b;
+	double bVirtual = x - a;
+	double aVirtual = x - bVirtual;
+	y = (a - aVirtual) + (b - bVirtual);
+}
+
+// a + b = x + y exactly, only when |a| >= |b|
+static void FastTwoSum(double a, double b, double& x, double& y)
+{
+	x = a + b;
+	y = b - (x - a);
+}
+
+static void Split(double a, double& high, double& low)
+{
+	double c = sSplitter * a;
+	double big = c - a;
+	high = c - big;
+	low = a - high;
+}
+
+// a * b = x + y exactly
+static void TwoProduct(double a, double b, double& x, double& y)
+{
+	x = a * b;
+
+	double aHigh, aLow, bHigh, bLow;
+	Split(a, aHigh, aLow);
+	Split(b, bHigh, bLow);
+
+	double error1 = x - (aHigh * bHigh);
+	double error2 = error1 - (aLow * bHigh);
+	double error3 = error2 - (aHigh * bLow);
+	y = (aLow * bLow) - error3;
+}
+
+// Writes a - b as an expansion, returns the number of terms
+static int Difference(double a, double b, double* h)
+{
+	double x, y;
+	TwoSum(a, -b, x, y);
+
+	int length = 0;
+	if (y != 0) { h[length++] = y; }
+	h[length++] = x;
+	return length;
+}
+
+// Adds two expansions by merging their terms from smallest to largest, h needs room for both
+static int ExpansionSum(int eLength, const double* e, int fLength, const double* f, double* h)
+{
+	int eIndex = 0;
+	int fIndex = 0;
+	int length = 0;
+
+	// Takes whichever of the next two terms is smaller
+	auto nextTerm = [&]()
+	{
+		if (fIndex >= fLength || (eIndex < eLength && std::abs(e[eIndex]) <= std::abs(f[fIndex])))
+		{
+			return e[eIndex++];
+		}
+		return f[fIndex++];
+	};
+
+	double q = nextTerm();
+	while (eIndex < eLength || fIndex < fLength)
+	{
+		double sum, error;
+		TwoSum(q, nextTerm(), sum, error);
+		q = sum;
+		if (error != 0) { h[length++] = error; }
+	}
+
+	if (q != 0 || length == 0) { h[length++] = q; }
+	return length;
+}
+
+// Multiplies an expansion by a double, h needs room for twice as many terms as e
+static int ScaleExpansion(int eLength, const double* e, double b, double* h)
+{
+	double q, error;
+	TwoProduct(e[0], b, q, error);
+
+	int length = 0;
+	if (error != 0) { h[length++] = error; }
+
+	for (int i = 1; i < eLength; i++)
+	{
+		double product, productError, sum;
+		TwoProduct(e[i], b, product, productError);
+
+		TwoSum(q, productError, sum, error);
+		if (error != 0) { h[length++] = error; }
+
+		FastTwoSum(product, sum, q, error);
+		if (error != 0) { h[length++] = error; }
+	}
+
+	if (q != 0 || length == 0) { h[length++] = q; }
+	return length;
+}
+
+// Multiplies two expansions, f can have at most half of sMaxScaled terms
+static int ExpansionProduct(int eLength, const double* e, int fLength, const double* f, double* h)
+{
+	double scaled[sMaxScaled];
+	double buffer[sMaxProduct];
+
+	// Sum into whichever buffer will end up being h
+	double* current = eLength % 2 == 1 ? h : buffer;
+	double* next = eLength % 2 == 1 ? buffer : h;
+
+	int length = ScaleExpansion(fLength, f, e[0], current);
+	for (int i = 1; i < eLength; i++)
+	{
+		int scaledLength = ScaleExpansion(fLength, f, e[i], scaled);
+		length = ExpansionSum(length, current, scaledLength, scaled, next);
+		std::swap(current, next);
+	}
+
+	return length;
+}
+
+// Writes a - b as an expansion, b is negated in place
+static int ExpansionDifference(int eLength, const double* e, int fLength, double* f, double* h)
+{
+	for (int i = 0; i < fLength; i++)
+	{
+		f[i] = -f[i];
+	}
+
+	return ExpansionSum(eLength, e, fLength, f, h);
+}
+
+static double Orient2DExact(const Vec2& a, const Vec2& b, const Vec2& c)
+{
+	double acx[2], bcy[2], acy[2], bcx[2];
+	int acxLength = Difference(a.x, c.x, acx);
+	int bcyLength = Difference(b.y, c.y, bcy);
+	int acyLength = Difference(a.y, c.y, acy);
+	int bcxLength = Difference(b.x, c.x, bcx);
+
+	double left[8], right[8], determinant[16];
+	int leftLength = ExpansionProduct(acxLength, acx, bcyLength, bcy, left);
+	int rightLength = ExpansionProduct(acyLength, acy, bcxLength, bcx, right);
+	int length = ExpansionDifference(leftLength, left, rightLength, right, determinant);
+
+	return determinant[length - 1];
+}
+
+double Orient2D(const Vec2& a, const Vec2& b, const Vec2& c)
+{
+	double detLeft = ((double)a.x - c.x) * ((double)b.y - c.y);
+	double detRight = ((double)a.y - c.y) * ((double)b.x - c.x);
+	double determinant = detLeft - detRight;
+
+	// When the two halves have different signs there is no way for rounding to change the answer
+	double detSum;
+	if (detLeft > 0)
+	{
+		if (detRight <= 0) { return determinant; }
+		detSum = detLeft + detRight;
+	}
+	else if (detLeft < 0)
+	{
+		if (detRight >= 0) { return determinant; }
+		detSum = -detLeft - detRight;
+	}
+	else
+	{
+		return determinant;
+	}
+
+	double errorBound = sOrientErrorBound * detSum;
+	if (determinant >= errorBound || -determinant >= errorBound) { return determinant; }
+
+	return Orient2DExact(a, b, c);
+}
+
+// The lift term of a point, dx^2 + dy^2
+static int Lift(int dxLength, const double* dx, int dyLength, const double* dy, double* h)
+{
+	double dx2[8], dy2[8];
+	int dx2Length = ExpansionProduct(dxLength, dx, dxLength, dx, dx2);
+	int dy2Length = ExpansionProduct(dyLength, dy, dyLength, dy, dy2);
+	return ExpansionSum(dx2Length, dx2, dy2Length, dy2, h);
+}
+
+// The cross term of two points, (ax * by) - (bx * ay)
+static int Cross(int axLength, const double* ax, int ayLength, const double* ay, int bxLength, const double* bx, int byLength, const double* by, double* h)
+{
+	double left[8], right[8];
+	int leftLength = ExpansionProduct(axLength, ax, byLength, by, left);
+	int rightLength = ExpansionProduct(bxLength, bx, ayLength, ay, right);
+	return ExpansionDifference(leftLength, left, rightLength, right, h);
+}
+
+static double InCircleExact(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d)
+{
+	double adx[2], ady[2], bdx[2], bdy[2], cdx[2], cdy[2];
+	int adxLength = Difference(a.x, d.x, adx);
+	int adyLength = Difference(a.y, d.y, ady);
+	int bdxLength = Difference(b.x, d.x, bdx);
+	int bdyLength = Difference(b.y, d.y, bdy);
+	int cdxLength = Difference(c.x, d.x, cdx);
+	int cdyLength = Difference(c.y, d.y, cdy);
+
+	double bc[16], ca[16], ab[16];
+	int bcLength = Cross(bdxLength, bdx, bdyLength, bdy, cdxLength, cdx, cdyLength, cdy, bc);
+	int caLength = Cross(cdxLength, cdx, cdyLength, cdy, adxLength, adx, adyLength, ady, ca);
+	int abLength = Cross(adxLength, adx, adyLength, ady, bdxLength, bdx, bdyLength, bdy, ab);
+
+	double aLift[16], bLift[16], cLift[16];
+	int aLiftLength = Lift(adxLength, adx, adyLength, ady, aLift);
+	int bLiftLength = Lift(bdxLength, bdx, bdyLength, bdy, bLift);
+	int cLiftLength = Lift(cdxLength, cdx, cdyLength, cdy, cLift);
+
+	double aDet[sMaxProduct], bDet[sMaxProduct], cDet[sMaxProduct];
+	int aDetLength = ExpansionProduct(aLiftLength, aLift, bcLength, bc, aDet);
+	int bDetLength = ExpansionProduct(bLiftLength, bLift, caLength, ca, bDet);
+	int cDetLength = ExpansionProduct(cLiftLength, cLift, abLength, ab, cDet);
+
+	double abDet[sMaxProduct * 2], determinant[sMaxProduct * 3];
+	int abDetLength = ExpansionSum(aDetLength, aDet, bDetLength, bDet, abDet);
+	int length = ExpansionSum(abDetLength, abDet, cDetLength, cDet, determinant);
+
+	return determinant[length - 1];
+}
+
+double InCircle(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d)
+{
+	double adx = (double)a.x - d.x;
+	double bdx = (double)b.x - d.x;
+	double cdx = (double)c.x - d.x;
+	double ady = (double)a.y - d.y;
+	double bdy = (double)b.y - d.y;
+	double cdy = (double)c.y - d.y;
+
+	double bdxcdy = bdx * cdy;
+	double cdxbdy = cdx * bdy;
+	double aLift = adx * adx + ady * ady;
+
+	double cdxady = cdx * ady;
+	double adxcdy = adx * cdy;
+	double bLift = bdx * bdx + bdy * bdy;
+
+	double adxbdy = adx * bdy;
+	double bdxady = bdx * ady;
+	double cLift = cdx * cdx + cdy * cdy;
+
+	double determinant = aLift * (bdxcdy - cdxbdy) + bLift * (cdxady - adxcdy) + cLift * (adxbdy - bdxady);
+
+	double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * aLift
+		+ (std::abs(cdxady) + std::abs(adxcdy)) * bLift
+		+ (std::abs(adxbdy) + std::abs(bdxady)) * cLift;
+
+	double errorBound = sInCircleErrorBound * permanent;
+	if (determinant > errorBound || -determinant > errorBound) { return determinant; }
+
+	return InCircleExact(a, b, c, d);
+}
+
+double InCirclePerturbed(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d)
+{
+	double determinant = InCircle(a, b, c, d);
+	if (determinant != 0) { return determinant; }
+
+	// A repeated point isn't a real circle, nudging it would only compare the point against itself
+	if (a == b || a == c || a == d || b == c || b == d || c == d) { return 0; }
+
+	// How the determinant changes as each point is lifted off the circle, the first point in left to right order gets
+	// the largest nudge so it decides the answer, unless the other three are on a line
+	const Vec2* points[4] = { &a, &b, &c, &d };
+	double changes[4] = { Orient2D(d, b, c), -Orient2D(a, c, d), Orient2D(a, b, d), -Orient2D(a, b, c) };
+
+	int order[4] = { 0, 1, 2, 3 };
+	std::sort(std::begin(order), std::end(order), [&points](int lhs, int rhs)
+		{
+			if (points[lhs]->x != points[rhs]->x) { return points[lhs]->x < points[rhs]->x; }
+			return points[lhs]->y < points[rhs]->y;
+		});
+
+	for (int i : order)
+	{
+		if (changes[i] != 0) { return changes[i]; }
+	}
+
+	return 0;
+}
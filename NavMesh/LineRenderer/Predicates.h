@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Vec2.h"
+
+// Geometric tests that always give the right sign, based on Shewchuk's robust predicates
+// https://www.cs.cmu.edu/~quake/robust.html
+// A quick floating point answer is used when it is far enough from 0 to be trusted, otherwise it is worked out exactly
+
+// Positive if a, b, c run counter clockwise, negative if they run clockwise and exactly 0 if they are on the same line
+double Orient2D(const Vec2& a, const Vec2& b, const Vec2& c);
+
+// Positive if d is inside the circle through a, b, c (given counter clockwise), negative if outside and exactly 0 if on it
+// The sign is reversed when a, b, c are clockwise
+double InCircle(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d);
+
+// Same as InCircle, but only returns 0 when two of the points are the same
+// Points exactly on the circle are treated as if each point had been nudged by a tiny amount, larger for points further
+// to the left (then lower), so whichever way round four points on a circle are tested they pick the same diagonal
+double InCirclePerturbed(const Vec2& a, const Vec2& b, const Vec2& c, const Vec2& d);
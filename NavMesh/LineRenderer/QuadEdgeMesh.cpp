@@ -0,0 +1,65 @@
+#include "QuadEdgeMesh.h"
+#include <utility>
+
+int QuadEdgeMesh::MakeEdge(int from, int to)
+{
+	int edge = (int)mNext.size();
+
+	// The edge is alone around both ends, and its dual loops around the single face on both sides
+	mNext.push_back(edge);
+	mNext.push_back(edge + 3);
+	mNext.push_back(edge + 2);
+	mNext.push_back(edge + 1);
+
+	mOrigin.push_back(from);
+	mOrigin.push_back(-1);
+	mOrigin.push_back(to);
+	mOrigin.push_back(-1);
+
+	mDeleted.push_back(false);
+
+	return edge;
+}
+
+void QuadEdgeMesh::Splice(int a, int b)
+{
+	int alpha = Rot(Onext(a));
+	int beta = Rot(Onext(b));
+
+	std::swap(mNext[a], mNext[b]);
+	std::swap(mNext[alpha], mNext[beta]);
+}
+
+int QuadEdgeMesh::Connect(int a, int b)
+{
+	int edge = MakeEdge(Dest(a), Org(b));
+	Splice(edge, Lnext(a));
+	Splice(Sym(edge), b);
+	return edge;
+}
+
+void QuadEdgeMesh::DeleteEdge(int edge)
+{
+	Splice(edge, Oprev(edge));
+	Splice(Sym(edge), Oprev(Sym(edge)));
+	mDeleted[edge / 4] = true;
+}
+
+int QuadEdgeMesh::Append(QuadEdgeMesh& other)
+{
+	int offset = (int)mNext.size();
+
+	for (int next : other.mNext)
+	{
+		mNext.push_back(next + offset);
+	}
+
+	mOrigin.insert(mOrigin.end(), other.mOrigin.begin(), other.mOrigin.end());
+	mDeleted.insert(mDeleted.end(), other.mDeleted.begin(), other.mDeleted.end());
+
+	other.mNext.clear();
+	other.mOrigin.clear();
+	other.mDeleted.clear();
+
+	return offset;
+}
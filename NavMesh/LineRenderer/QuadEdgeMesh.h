@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+// Guibas and Stolfi's quad edge structure, used by the divide and conquer triangulation
+// Each edge is made of four quarter edges: 0 and 2 are the edge in both directions, 1 and 3 are the edge between the faces
+// on either side. Quarter edges are referred to by index, edge * 4 + quarter
+class QuadEdgeMesh
+{
+	// The next quarter edge counter clockwise around the origin of each quarter edge
+	std::vector<int> mNext;
+
+	// Vertex id at the start of each quarter edge, only used by quarters 0 and 2
+	std::vector<int> mOrigin;
+
+	std::vector<bool> mDeleted;
+
+public:
+	static int Rot(int edge) { return (edge & ~3) | ((edge + 1) & 3); }
+	static int Sym(int edge) { return (edge & ~3) | ((edge + 2) & 3); }
+	static int InvRot(int edge) { return (edge & ~3) | ((edge + 3) & 3); }
+
+	int Onext(int edge) const { return mNext[edge]; }
+	int Oprev(int edge) const { return Rot(Onext(Rot(edge))); }
+	int Lnext(int edge) const { return Rot(Onext(InvRot(edge))); }
+	int Rprev(int edge) const { return Onext(Sym(edge)); }
+
+	int Org(int edge) const { return mOrigin[edge]; }
+	int Dest(int edge) const { return mOrigin[Sym(edge)]; }
+
+	// Creates an edge that isn't connected to anything
+	int MakeEdge(int from, int to);
+
+	// Joins or separates the rings of edges around the origins of a and b
+	void Splice(int a, int b);
+
+	// Adds an edge from the end of a to the start of b, so all three share the same left face
+	int Connect(int a, int b);
+
+	void DeleteEdge(int edge);
+	bool IsDeleted(int edge) const { return mDeleted[edge / 4]; }
+
+	// Moves all of the other mesh's edges onto the end of this one, returns how far their indices were moved by
+	int Append(QuadEdgeMesh& other);
+
+	int GetQuarterEdgeCount() const { return (int)mNext.size(); }
+};
@@ -0,0 +1,143 @@
+#include "SearchContext.h"
+
+#include <algorithm>
+
+void SearchContext::Reset(int nodeCount, int endNode)
+{
+	if ((int)mStamps.size() != nodeCount)
+	{
+		mStamps.assign(nodeCount, 0);
+		mGScores.resize(nodeCount);
+		mFScores.resize(nodeCount);
+		mPrevious.resize(nodeCount);
+		mHeapIndices.resize(nodeCount);
+		mGeneration = 0;
+	}
+
+	// Once the counter wraps round the old stamps could match again
+	mGeneration++;
+	if (mGeneration == 0)
+	{
+		std::fill(mStamps.begin(), mStamps.end(), 0);
+		mGeneration = 1;
+	}
+
+	mHeap.clear();
+	mPath.clear();
+
+	mEndNode = endNode;
+	mExpansions = 0;
+	mClosestNode = -1;
+	mClosestDistance = 0;
+}
+
+void SearchContext::Open(int node, float gScore, float fScore, int previous)
+{
+	if (IsVisited(node))
+	{
+		// Closed nodes are final, open ones only move up if this way is shorter
+		if (mHeapIndices[node] == CLOSED || gScore >= mGScores[node]) { return; }
+
+		mGScores[node] = gScore;
+		mFScores[node] = fScore;
+		mPrevious[node] = previous;
+		SiftUp(mHeapIndices[node]);
+		return;
+	}
+
+	mStamps[node] = mGeneration;
+	mGScores[node] = gScore;
+	mFScores[node] = fScore;
+	mPrevious[node] = previous;
+
+	mHeapIndices[node] = (int)mHeap.size();
+	mHeap.push_back(node);
+	SiftUp(mHeapIndices[node]);
+}
+
+int SearchContext::PopLowest()
+{
+	int lowest = mHeap[0];
+	mHeapIndices[lowest] = CLOSED;
+
+	// Move the last entry to the top and let it sink back down
+	int last = mHeap.back();
+	mHeap.pop_back();
+	if (!mHeap.empty())
+	{
+		mHeap[0] = last;
+		mHeapIndices[last] = 0;
+		SiftDown(0);
+	}
+
+	return lowest;
+}
+
+void SearchContext::AddExpansion(int node, float distanceToEnd)
+{
+	mExpansions++;
+	if (mClosestNode == -1 || distanceToEnd < mClosestDistance)
+	{
+		mClosestNode = node;
+		mClosestDistance = distanceToEnd;
+	}
+}
+
+void SearchContext::BuildPath(int endNode)
+{
+	mPath.clear();
+	for (int node = endNode; node != -1; node = mPrevious[node])
+	{
+		mPath.push_back(node);
+	}
+	std::reverse(mPath.begin(), mPath.end());
+}
+
+void SearchContext::SiftUp(int index)
+{
+	int node = mHeap[index];
+	float score = mFScores[node];
+
+	while (index > 0)
+	{
+		int parent = (index - 1) / HEAP_ARITY;
+		if (mFScores[mHeap[parent]] <= score) { break; }
+
+		mHeap[index] = mHeap[parent];
+		mHeapIndices[mHeap[index]] = index;
+		index = parent;
+	}
+
+	mHeap[index] = node;
+	mHeapIndices[node] = index;
+}
+
+void SearchContext::SiftDown(int index)
+{
+	int node = mHeap[index];
+	float score = mFScores[node];
+	int size = (int)mHeap.size();
+
+	while (true)
+	{
+		int firstChild = index * HEAP_ARITY + 1;
+		if (firstChild >= size) { break; }
+
+		// Find the lowest of the children
+		int lowest = firstChild;
+		int lastChild = std::min(firstChild + HEAP_ARITY, size);
+		for (int child = firstChild + 1; child < lastChild; child++)
+		{
+			if (mFScores[mHeap[child]] < mFScores[mHeap[lowest]]) { lowest = child; }
+		}
+
+		if (mFScores[mHeap[lowest]] >= score) { break; }
+
+		mHeap[index] = mHeap[lowest];
+		mHeapIndices[mHeap[index]] = index;
+		index = lowest;
+	}
+
+	mHeap[index] = node;
+	mHeapIndices[node] = index;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+// Where a node search is up to, searches that run out of budget can be carried on later
+enum class NodeSearchStatus
+{
+	IN_PROGRESS,
+	FOUND,
+	NOT_FOUND
+};
+
+// Everything A* writes while searching, kept apart from the graph so the graph is only ever read
+// Keeping one around between searches means a search doesn't allocate once the arrays have grown to the size of the graph
+class SearchContext
+{
+	// Nodes touched by the current search are stamped with its generation, so nothing has to be cleared between searches
+	std::vector<unsigned int> mStamps;
+	unsigned int mGeneration = 0;
+
+	std::vector<float> mGScores;
+	std::vector<float> mFScores;
+	std::vector<int> mPrevious;
+	// Where each node is in the open list heap, CLOSED once it has been expanded
+	std::vector<int> mHeapIndices;
+
+	// The open list, a min heap on f score
+	std::vector<int> mHeap;
+
+	// Nodes of the last path found, start first
+	std::vector<int> mPath;
+
+	// The search being run, kept so a paused search can carry on
+	int mEndNode = -1;
+	int mExpansions = 0;
+	// Expanded node with the shortest straight line to the end, where a partial path goes to
+	int mClosestNode = -1;
+	float mClosestDistance = 0;
+
+public:
+	static const int CLOSED = -1;
+	// Children per heap entry, a wider heap is shallower and four children sit next to each other in memory
+	static const int HEAP_ARITY = 4;
+
+	// Starts a new search over a graph with this many nodes
+	void Reset(int nodeCount, int endNode = -1);
+
+	bool IsVisited(int node) const { return mStamps[node] == mGeneration; }
+	bool IsClosed(int node) const { return IsVisited(node) && mHeapIndices[node] == CLOSED; }
+	float GetGScore(int node) const { return mGScores[node]; }
+	float GetFScore(int node) const { return mFScores[node]; }
+	int GetPrevious(int node) const { return mPrevious[node]; }
+
+	// Adds the node to the open list, or lowers its scores if it is already open with a worse g score
+	void Open(int node, float gScore, float fScore, int previous);
+	// Takes the open node with the lowest f score off the open list and closes it
+	int PopLowest();
+	bool IsOpenEmpty() const { return mHeap.empty(); }
+
+	// Fills the path by following the previous nodes back from the end node
+	void BuildPath(int endNode);
+	std::vector<int>& GetPath() { return mPath; }
+	const std::vector<int>& GetPath() const { return mPath; }
+	// Sets the path without searching, for node paths found earlier
+	void SetPath(const std::vector<int>& path) { mPath = path; }
+
+	int GetEndNode() const { return mEndNode; }
+	int GetExpansions() const { return mExpansions; }
+	int GetClosestNode() const { return mClosestNode; }
+	// Counts an expansion, remembering the node if it is the closest to the end so far
+	void AddExpansion(int node, float distanceToEnd);
+
+private:
+	void SiftUp(int index);
+	void SiftDown(int index);
+};
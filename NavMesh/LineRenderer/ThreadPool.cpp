@@ -0,0 +1,68 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount)
+{
+	if (threadCount <= 0) { threadCount = (int)std::thread::hardware_concurrency(); }
+	if (threadCount <= 0) { threadCount = 1; }
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		mThreads.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mJobAdded.notify_all();
+
+	for (std::thread& thread : mThreads)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.push_back(std::move(job));
+	}
+	mJobAdded.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mJobsFinished.wait(lock, [this]() { return mJobs.empty() && mRunningJobs == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobAdded.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+
+			// Finish off anything still queued before stopping
+			if (mJobs.empty()) { return; }
+
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+			mRunningJobs++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRunningJobs--;
+		}
+		mJobsFinished.notify_all();
+	}
+}
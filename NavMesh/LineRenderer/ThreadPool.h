@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that run jobs from a shared queue
+class ThreadPool
+{
+	std::vector<std::thread> mThreads;
+	std::deque<std::function<void()>> mJobs;
+
+	std::mutex mMutex;
+	std::condition_variable mJobAdded;
+	std::condition_variable mJobsFinished;
+
+	// Jobs that have been taken off the queue but haven't finished yet
+	int mRunningJobs = 0;
+	bool mStopping = false;
+
+public:
+	// A thread count of 0 uses one thread per core
+	ThreadPool(int threadCount = 0);
+
+	~ThreadPool();
+	ThreadPool(const ThreadPool& other) = delete;
+	ThreadPool& operator=(const ThreadPool& other) = delete;
+
+	void Submit(std::function<void()> job);
+
+	// Blocks until every submitted job has finished
+	void Wait();
+
+	int GetThreadCount() const { return (int)mThreads.size(); }
+
+private:
+	void WorkerLoop();
+};
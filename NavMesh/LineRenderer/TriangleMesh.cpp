@@ -0,0 +1,362 @@
+#include "TriangleMesh.h"
+#include "DelaunayTriangulation.h"
+
+int TriangleMesh::AddVertex(const Vec2& point)
+{
+	mVertices.push_back(point);
+	mVertexTriangles.push_back(-1);
+	return (int)mVertices.size() - 1;
+}
+
+int TriangleMesh::AddTriangle(int a, int b, int c)
+{
+	mTriangles.push_back(MeshTriangle());
+	int triangle = (int)mTriangles.size() - 1;
+	SetTriangle(triangle, a, b, c);
+	mLiveTriangleCount++;
+	return triangle;
+}
+
+void TriangleMesh::RemoveTriangle(int triangle)
+{
+	MeshTriangle& tri = mTriangles[triangle];
+	if (tri.mRemoved) { return; }
+	tri.mRemoved = true;
+	mLiveTriangleCount--;
+
+	for (int i = 0; i < 3; i++)
+	{
+		ReplaceNeighbour(tri.mNeighbours[i], triangle, -1);
+	}
+
+	// Point the vertices at a triangle that still uses them
+	for (int i = 0; i < 3; i++)
+	{
+		int vertex = tri.mVerts[i];
+		if (mVertexTriangles[vertex] != triangle) { continue; }
+
+		// The two edges touching this vertex are edge i and the edge before it
+		int next = tri.mNeighbours[i];
+		int previous = tri.mNeighbours[(i + 2) % 3];
+
+		if (next != -1) { mVertexTriangles[vertex] = next; }
+		else if (previous != -1) { mVertexTriangles[vertex] = previous; }
+		else { mVertexTriangles[vertex] = -1; }
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		tri.mNeighbours[i] = -1;
+	}
+}
+
+void TriangleMesh::SplitTriangle(int triangle, int vertex, int outTriangles[3])
+{
+	MeshTriangle old = mTriangles[triangle];
+	int a = old.mVerts[0];
+	int b = old.mVerts[1];
+	int c = old.mVerts[2];
+
+	int t0 = triangle;
+	int t1 = AddTriangle(b, c, vertex);
+	int t2 = AddTriangle(c, a, vertex);
+	SetTriangle(t0, a, b, vertex);
+
+	MeshTriangle& tri0 = mTriangles[t0];
+	tri0.mNeighbours[0] = old.mNeighbours[0];
+	tri0.mNeighbours[1] = t1;
+	tri0.mNeighbours[2] = t2;
+	tri0.mConstrained[0] = old.mConstrained[0];
+
+	MeshTriangle& tri1 = mTriangles[t1];
+	tri1.mNeighbours[0] = old.mNeighbours[1];
+	tri1.mNeighbours[1] = t2;
+	tri1.mNeighbours[2] = t0;
+	tri1.mConstrained[0] = old.mConstrained[1];
+
+	MeshTriangle& tri2 = mTriangles[t2];
+	tri2.mNeighbours[0] = old.mNeighbours[2];
+	tri2.mNeighbours[1] = t0;
+	tri2.mNeighbours[2] = t1;
+	tri2.mConstrained[0] = old.mConstrained[2];
+
+	ReplaceNeighbour(old.mNeighbours[1], triangle, t1);
+	ReplaceNeighbour(old.mNeighbours[2], triangle, t2);
+
+	outTriangles[0] = t0;
+	outTriangles[1] = t1;
+	outTriangles[2] = t2;
+}
+
+int TriangleMesh::SplitEdge(int triangle, int edge, int vertex, int outTriangles[4])
+{
+	MeshTriangle old = mTriangles[triangle];
+	int a = old.mVerts[edge];
+	int b = old.mVerts[(edge + 1) % 3];
+	int c = old.mVerts[(edge + 2) % 3];
+	int nbc = old.mNeighbours[(edge + 1) % 3];
+	int nca = old.mNeighbours[(edge + 2) % 3];
+	bool constrained = old.mConstrained[edge];
+
+	int neighbour = old.mNeighbours[edge];
+
+	// (a, b, c) becomes (a, p, c) and (p, b, c)
+	int t0 = triangle;
+	int t1 = AddTriangle(vertex, b, c);
+	SetTriangle(t0, a, vertex, c);
+
+	int u0 = -1;
+	int u1 = -1;
+
+	if (neighbour != -1)
+	{
+		// (b, a, d) becomes (b, p, d) and (p, a, d)
+		MeshTriangle oldNeighbour = mTriangles[neighbour];
+		int sharedEdge = GetSharedEdge(neighbour, triangle);
+		int d = oldNeighbour.mVerts[(sharedEdge + 2) % 3];
+		int nad = oldNeighbour.mNeighbours[(sharedEdge + 1) % 3];
+		int ndb = oldNeighbour.mNeighbours[(sharedEdge + 2) % 3];
+
+		u0 = neighbour;
+		u1 = AddTriangle(vertex, a, d);
+		SetTriangle(u0, b, vertex, d);
+
+		MeshTriangle& triU0 = mTriangles[u0];
+		triU0.mNeighbours[0] = t1;
+		triU0.mNeighbours[1] = u1;
+		triU0.mNeighbours[2] = ndb;
+		triU0.mConstrained[0] = constrained;
+		triU0.mConstrained[2] = oldNeighbour.mConstrained[(sharedEdge + 2) % 3];
+
+		MeshTriangle& triU1 = mTriangles[u1];
+		triU1.mNeighbours[0] = t0;
+		triU1.mNeighbours[1] = nad;
+		triU1.mNeighbours[2] = u0;
+		triU1.mConstrained[0] = constrained;
+		triU1.mConstrained[1] = oldNeighbour.mConstrained[(sharedEdge + 1) % 3];
+
+		ReplaceNeighbour(nad, neighbour, u1);
+	}
+
+	MeshTriangle& tri0 = mTriangles[t0];
+	tri0.mNeighbours[0] = u1;
+	tri0.mNeighbours[1] = t1;
+	tri0.mNeighbours[2] = nca;
+	tri0.mConstrained[0] = constrained;
+	tri0.mConstrained[2] = old.mConstrained[(edge + 2) % 3];
+
+	MeshTriangle& tri1 = mTriangles[t1];
+	tri1.mNeighbours[0] = u0;
+	tri1.mNeighbours[1] = nbc;
+	tri1.mNeighbours[2] = t0;
+	tri1.mConstrained[0] = constrained;
+	tri1.mConstrained[1] = old.mConstrained[(edge + 1) % 3];
+
+	ReplaceNeighbour(nbc, triangle, t1);
+
+	outTriangles[0] = t0;
+	outTriangles[1] = t1;
+	if (neighbour == -1) { return 2; }
+
+	outTriangles[2] = u0;
+	outTriangles[3] = u1;
+	return 4;
+}
+
+void TriangleMesh::FlipEdge(int triangle, int edge)
+{
+	MeshTriangle tri = mTriangles[triangle];
+	int neighbour = tri.mNeighbours[edge];
+	MeshTriangle other = mTriangles[neighbour];
+	int sharedEdge = GetSharedEdge(neighbour, triangle);
+
+	int a = tri.mVerts[edge];
+	int b = tri.mVerts[(edge + 1) % 3];
+	int c = tri.mVerts[(edge + 2) % 3];
+	int d = other.mVerts[(sharedEdge + 2) % 3];
+
+	int nbc = tri.mNeighbours[(edge + 1) % 3];
+	int nca = tri.mNeighbours[(edge + 2) % 3];
+	int nad = other.mNeighbours[(sharedEdge + 1) % 3];
+	int ndb = other.mNeighbours[(sharedEdge + 2) % 3];
+
+	SetTriangle(triangle, c, a, d);
+	MeshTriangle& newTri = mTriangles[triangle];
+	newTri.mNeighbours[0] = nca;
+	newTri.mNeighbours[1] = nad;
+	newTri.mNeighbours[2] = neighbour;
+	newTri.mConstrained[0] = tri.mConstrained[(edge + 2) % 3];
+	newTri.mConstrained[1] = other.mConstrained[(sharedEdge + 1) % 3];
+
+	SetTriangle(neighbour, d, b, c);
+	MeshTriangle& newOther = mTriangles[neighbour];
+	newOther.mNeighbours[0] = ndb;
+	newOther.mNeighbours[1] = nbc;
+	newOther.mNeighbours[2] = triangle;
+	newOther.mConstrained[0] = other.mConstrained[(sharedEdge + 2) % 3];
+	newOther.mConstrained[1] = tri.mConstrained[(edge + 1) % 3];
+
+	ReplaceNeighbour(nad, neighbour, triangle);
+	ReplaceNeighbour(nbc, triangle, neighbour);
+
+	mFlipCount++;
+}
+
+MeshEdge TriangleMesh::FindEdge(int from, int to) const
+{
+	int start = mVertexTriangles[from];
+	if (start == -1) { return MeshEdge{}; }
+
+	// Walk around the vertex one way, and if we hit the edge of the mesh walk back around the other way
+	for (int direction = 0; direction < 2; direction++)
+	{
+		int current = start;
+		do
+		{
+			const MeshTriangle& tri = mTriangles[current];
+			int corner = 0;
+			while (tri.mVerts[corner] != from) { corner++; }
+
+			if (tri.mVerts[(corner + 1) % 3] == to) { return MeshEdge{ current, corner }; }
+			if (tri.mVerts[(corner + 2) % 3] == to) { return MeshEdge{ current, (corner + 2) % 3 }; }
+
+			current = direction == 0 ? tri.mNeighbours[corner] : tri.mNeighbours[(corner + 2) % 3];
+		} while (current != -1 && current != start);
+
+		// Went all the way around
+		if (current == start) { break; }
+	}
+
+	return MeshEdge{};
+}
+
+std::vector<int> TriangleMesh::GetTrianglesAroundVertex(int vertex) const
+{
+	std::vector<int> triangles;
+
+	int start = mVertexTriangles[vertex];
+	if (start == -1) { return triangles; }
+	triangles.push_back(start);
+
+	// Walk around the vertex one way, and if we hit the edge of the mesh walk back around the other way
+	for (int direction = 0; direction < 2; direction++)
+	{
+		int current = start;
+		while (true)
+		{
+			const MeshTriangle& tri = mTriangles[current];
+			int corner = 0;
+			while (tri.mVerts[corner] != vertex) { corner++; }
+
+			current = direction == 0 ? tri.mNeighbours[corner] : tri.mNeighbours[(corner + 2) % 3];
+			if (current == -1 || current == start) { break; }
+
+			triangles.push_back(current);
+		}
+
+		// Went all the way around
+		if (current == start) { break; }
+	}
+
+	return triangles;
+}
+
+int TriangleMesh::GetSharedEdge(int triangle, int neighbour) const
+{
+	for (int i = 0; i < 3; i++)
+	{
+		if (mTriangles[triangle].mNeighbours[i] == neighbour) { return i; }
+	}
+	return -1;
+}
+
+void TriangleMesh::SetConstrained(int triangle, int edge, bool constrained)
+{
+	mTriangles[triangle].mConstrained[edge] = constrained;
+
+	int neighbour = mTriangles[triangle].mNeighbours[edge];
+	if (neighbour == -1) { return; }
+
+	mTriangles[neighbour].mConstrained[GetSharedEdge(neighbour, triangle)] = constrained;
+}
+
+bool TriangleMesh::HasVertex(int triangle, int vertex) const
+{
+	const MeshTriangle& tri = mTriangles[triangle];
+	return tri.mVerts[0] == vertex || tri.mVerts[1] == vertex || tri.mVerts[2] == vertex;
+}
+
+void TriangleMesh::CreateNavigationArrays(std::vector<Vec2>& vertices, std::vector<NavTriangle>& triangles, std::vector<NavNeighbours>& neighbours, std::vector<bool>& constrainedEdges) const
+{
+	vertices.clear();
+	triangles.clear();
+	neighbours.clear();
+	constrainedEdges.clear();
+
+	// New index of each vertex and triangle, -1 if it isn't kept
+	std::vector<int> vertexIndices(mVertices.size(), -1);
+	std::vector<int> triangleIndices(mTriangles.size(), -1);
+
+	for (int i = 0; i < (int)mTriangles.size(); i++)
+	{
+		if (mTriangles[i].mRemoved) { continue; }
+
+		triangleIndices[i] = (int)triangles.size();
+
+		NavTriangle triangle;
+		for (int j = 0; j < 3; j++)
+		{
+			int vertex = mTriangles[i].mVerts[j];
+			if (vertexIndices[vertex] == -1)
+			{
+				vertexIndices[vertex] = (int)vertices.size();
+				vertices.push_back(mVertices[vertex]);
+			}
+
+			triangle.mVerts[j] = vertexIndices[vertex];
+		}
+		triangles.push_back(triangle);
+	}
+
+	// Neighbours can only be renumbered once every kept triangle has its new index
+	for (int i = 0; i < (int)mTriangles.size(); i++)
+	{
+		if (mTriangles[i].mRemoved) { continue; }
+
+		NavNeighbours triangleNeighbours;
+		for (int j = 0; j < 3; j++)
+		{
+			int neighbour = mTriangles[i].mNeighbours[j];
+			triangleNeighbours.mTriangles[j] = neighbour == -1 ? -1 : triangleIndices[neighbour];
+			constrainedEdges.push_back(mTriangles[i].mConstrained[j]);
+		}
+		neighbours.push_back(triangleNeighbours);
+	}
+}
+
+void TriangleMesh::SetTriangle(int triangle, int a, int b, int c)
+{
+	MeshTriangle& tri = mTriangles[triangle];
+	tri = MeshTriangle();
+	tri.mVerts[0] = a;
+	tri.mVerts[1] = b;
+	tri.mVerts[2] = c;
+
+	mVertexTriangles[a] = triangle;
+	mVertexTriangles[b] = triangle;
+	mVertexTriangles[c] = triangle;
+}
+
+void TriangleMesh::ReplaceNeighbour(int triangle, int oldNeighbour, int newNeighbour)
+{
+	if (triangle == -1) { return; }
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (mTriangles[triangle].mNeighbours[i] == oldNeighbour)
+		{
+			mTriangles[triangle].mNeighbours[i] = newNeighbour;
+			return;
+		}
+	}
+}
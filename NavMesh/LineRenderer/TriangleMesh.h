@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Vec2.h"
+#include "NavTriangle.h"
+#include <vector>
+
+// A triangle stored by vertex id, along with the triangle on the other side of each edge
+// Edge i runs from mVerts[i] to mVerts[(i + 1) % 3], points are stored in clockwise order
+struct MeshTriangle
+{
+	int mVerts[3] = { -1, -1, -1 };
+	int mNeighbours[3] = { -1, -1, -1 };
+	// Constrained edges (obstacle edges) are never flipped
+	bool mConstrained[3] = { false, false, false };
+	bool mRemoved = false;
+};
+
+// Used to refer to a single edge of a triangle in the mesh
+struct MeshEdge
+{
+	int triangle = -1;
+	int edge = -1;
+};
+
+// Indexed triangle mesh used as the working structure while building the navigation mesh
+class TriangleMesh
+{
+	std::vector<Vec2> mVertices;
+	std::vector<MeshTriangle> mTriangles;
+
+	// One triangle that uses each vertex, used to start walking around a vertex
+	std::vector<int> mVertexTriangles;
+
+	// Total number of edge flips made on this mesh
+	int mFlipCount = 0;
+
+	// Triangles that haven't been removed
+	int mLiveTriangleCount = 0;
+
+public:
+	int AddVertex(const Vec2& point);
+	int AddTriangle(int a, int b, int c);
+	void RemoveTriangle(int triangle);
+
+	// Splits a triangle into three around a vertex that lies inside of it, returns the three triangles
+	void SplitTriangle(int triangle, int vertex, int outTriangles[3]);
+
+	// Splits the triangles on both sides of an edge around a vertex that lies on it, returns the (up to) four triangles
+	int SplitEdge(int triangle, int edge, int vertex, int outTriangles[4]);
+
+	// Swaps the diagonal of the two triangles sharing the edge
+	// Triangle (a, b, c) sharing edge a->b with (b, a, d) becomes (c, a, d), and the neighbour becomes (d, b, c)
+	void FlipEdge(int triangle, int edge);
+
+	// Finds a triangle with an edge joining the two vertices
+	MeshEdge FindEdge(int from, int to) const;
+
+	// All of the triangles that use a vertex, found by walking around it
+	std::vector<int> GetTrianglesAroundVertex(int vertex) const;
+
+	// Which edge of the triangle borders the neighbour, -1 if they aren't adjacent
+	int GetSharedEdge(int triangle, int neighbour) const;
+
+	void SetConstrained(int triangle, int edge, bool constrained);
+
+	// Only links this side, used when building a mesh from triangles made elsewhere
+	void SetNeighbour(int triangle, int edge, int neighbour) { mTriangles[triangle].mNeighbours[edge] = neighbour; }
+
+	const Vec2& GetVertex(int vertex) const { return mVertices[vertex]; }
+	Vec2& GetVertex(int vertex) { return mVertices[vertex]; }
+	const Vec2& GetTrianglePoint(int triangle, int corner) const { return mVertices[mTriangles[triangle].mVerts[corner]]; }
+	const MeshTriangle& GetTriangle(int triangle) const { return mTriangles[triangle]; }
+
+	int GetVertexTriangle(int vertex) const { return mVertexTriangles[vertex]; }
+	int GetNeighbour(int triangle, int edge) const { return mTriangles[triangle].mNeighbours[edge]; }
+	int GetOppositeVertex(int triangle, int edge) const { return mTriangles[triangle].mVerts[(edge + 2) % 3]; }
+	bool IsConstrained(int triangle, int edge) const { return mTriangles[triangle].mConstrained[edge]; }
+	bool IsRemoved(int triangle) const { return mTriangles[triangle].mRemoved; }
+	bool HasVertex(int triangle, int vertex) const;
+
+	int GetVertexCount() const { return (int)mVertices.size(); }
+	int GetTriangleCount() const { return (int)mTriangles.size(); }
+	int GetFlipCount() const { return mFlipCount; }
+	int GetLiveTriangleCount() const { return mLiveTriangleCount; }
+
+	// Copies the triangles that haven't been removed into the flat arrays used at runtime
+	// Vertices no triangle uses are dropped and everything is renumbered, neighbours that were removed become -1
+	// constrainedEdges gets three flags per kept triangle, one for each edge that came from an obstacle
+	void CreateNavigationArrays(std::vector<Vec2>& vertices, std::vector<NavTriangle>& triangles, std::vector<NavNeighbours>& neighbours, std::vector<bool>& constrainedEdges) const;
+
+private:
+	void SetTriangle(int triangle, int a, int b, int c);
+	void ReplaceNeighbour(int triangle, int oldNeighbour, int newNeighbour);
+};
@@ -2,7 +2,9 @@
 #include "Obstacle.h"
 #include "Triangle.h"
 #include "TriEdge.h"
+#include "NavigationMesh.h"
 
+#include <algorithm>
 #include <cmath>
 
 bool Vector2IsEqual(Vec2 a, Vec2 b)
@@ -105,57 +107,6 @@ bool IsPointInConvexObstacle(Vec2 point, std::vector<Obstacle*>& obstacles)
 	return false;
 }
 
-bool IsTriangleInObstacle(Triangle* triangle, const std::vector<Obstacle*>& obstacles)
-{
-	std::vector<TriEdge> overlappedEdges;
-	Vec2 normals[3];
-	normals[0] = (triangle->mEdgeList[0].mPoints[0] - triangle->mEdgeList[0].mPoints[1]).GetRotatedBy270().GetNormalised();
-	normals[1] = (triangle->mEdgeList[1].mPoints[0] - triangle->mEdgeList[1].mPoints[1]).GetRotatedBy270().GetNormalised();
-	normals[2] = (triangle->mEdgeList[2].mPoints[0] - triangle->mEdgeList[2].mPoints[1]).GetRotatedBy270().GetNormalised();
-
-	Vec2 edgeMidPoints[3];
-	edgeMidPoints[0] = ((triangle->mEdgeList[0].mPoints[0] * 1.22f) + triangle->mEdgeList[0].mPoints[1]) / 2.22f;
-	edgeMidPoints[1] = ((triangle->mEdgeList[1].mPoints[0] * 1.22f) + triangle->mEdgeList[1].mPoints[1]) / 2.22f;
-	edgeMidPoints[2] = ((triangle->mEdgeList[2].mPoints[0] * 1.22f) + triangle->mEdgeList[2].mPoints[1]) / 2.22f;
-
-	int count = 0;
-
-	for (int i = 0; i < 3; i++)
-	{
-		Vec2 point = edgeMidPoints[i] - (normals[i] * 0.01f);
-		for (Obstacle* ob : obstacles)
-		{
-			std::vector<TriEdge> currentObEdges;
-			Vec2 endPoint = edgeMidPoints[i] + normals[i] * 1000;
-
-			currentObEdges = ConstructObstacleEdges(ob);
-
-			for (TriEdge e : currentObEdges)
-			{
-				float result1 = PseudoCross((endPoint - point), (e.mPoints[0] - point));
-				float result2 = PseudoCross((endPoint - point), (e.mPoints[1] - point));
-
-				float result3 = PseudoCross((e.mPoints[1] - e.mPoints[0]), (point - e.mPoints[0]));
-				float result4 = PseudoCross((e.mPoints[1] - e.mPoints[0]), (endPoint - e.mPoints[0]));
-
-
-				if (result1 * result2 < 0 && result3 * result4 < 0)
-				{
-					count++;
-					overlappedEdges.push_back(e);
-				}
-			}
-
-			if (count % 2 > 0)
-			{
-				return true;
-			}
-		}
-	}
-
-	return false;
-}
-
 std::vector<TriEdge> ConstructObstacleEdges(Obstacle* ob)
 {
 	std::vector<TriEdge> returnEdges;
@@ -205,33 +156,44 @@ std::vector<Vec2> AddBufferToObstacles(const std::vector<Obstacle*>& obstacles)
 	return returnPoints;
 }
 
-Vec2 GetTriangleCentre(Triangle*& triangle)
+std::vector<Vec2> FindTwoCommonVerts(const NavigationMesh& navMesh, int polygon1, int polygon2)
 {
-	// Average the points location
-	float centerX = (triangle->mPoints[0].x + triangle->mPoints[1].x + triangle->mPoints[2].x) / 3;
-	float centerY = (triangle->mPoints[0].y + triangle->mPoints[1].y + triangle->mPoints[2].y) / 3;
-
-	return Vec2{ centerX, centerY };
-}
-
-std::vector<Vec2> FindTwoCommonVerts(Triangle*& tri1, Triangle*& tri2)
-{
-	int index = 0;
-
-	for (int i = 0; i < 3; i++)
+	// Corners of the first polygon that the second one also uses, in the first polygon's order
+	std::vector<int> shared;
+	for (int i = 0; i < navMesh.GetPolygonSize(polygon1); i++)
 	{
-		if (std::find(std::begin(tri2->mPoints), std::end(tri2->mPoints), tri1->mPoints[i]) == std::end(tri2->mPoints))
+		int vertex = navMesh.GetPolygonVertex(polygon1, i);
+		for (int j = 0; j < navMesh.GetPolygonSize(polygon2); j++)
 		{
-			index = i;
+			if (navMesh.GetPolygonVertex(polygon2, j) == vertex)
+			{
+				shared.push_back(vertex);
+				break;
+			}
 		}
 	}
 
-	std::vector<Vec2> returnList;
-	for (int i = 0; i < 3; i++)
+	// Polygons can share a straight run of edges, only the two ends of it matter
+	int start = 0;
+	int end = 1;
+	float longest = -1;
+	for (int i = 0; i < (int)shared.size(); i++)
 	{
-		if (i == index) { continue; }
-		returnList.push_back(tri1->mPoints[i]);
+		for (int j = i + 1; j < (int)shared.size(); j++)
+		{
+			float length = (navMesh.GetVertex(shared[j]) - navMesh.GetVertex(shared[i])).GetMagnitude();
+			if (length > longest)
+			{
+				longest = length;
+				start = i;
+				end = j;
+			}
+		}
 	}
+
+	std::vector<Vec2> returnList;
+	returnList.push_back(navMesh.GetVertex(shared[start]));
+	returnList.push_back(navMesh.GetVertex(shared[end]));
 	return returnList;
 }
 
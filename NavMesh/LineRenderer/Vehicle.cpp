@@ -1,6 +1,6 @@
 #include "Vehicle.h"
 
-Vehicle::Vehicle(NodeGraph* nodeGraph, float width, Colour colour, World* world) : PathAgent(nodeGraph, width, colour, world)
+Vehicle::Vehicle(const NodeGraph* nodeGraph, float width, Colour colour, World* world) : PathAgent(nodeGraph, width, colour, world)
 {
 }
 
@@ -9,7 +9,7 @@ class Vehicle : public PathAgent
 	float mMaxForce;
 
 public:
-	Vehicle(NodeGraph* nodeGraph, float width, Colour colour, World* world);
+	Vehicle(const NodeGraph* nodeGraph, float width, Colour colour, World* world);
 
 	void ApplyForce();
 	void Seek();
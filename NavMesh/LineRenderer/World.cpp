@@ -17,6 +17,9 @@ World::World()
 
 World::~World()
 {
+	delete mFlowField;
+	delete mPathScheduler;
+	delete mPathHierarchy;
 	delete mNodeGraph;
 	delete mNavMesh;
 
@@ -90,16 +93,19 @@ void World::Initialise()
 		v = Vec2((v.x - (level.GetWidth() * 0.5f)), -(v.y - (level.GetHeight() * 0.5f))) * level.GetCellSize();
 	}
 
-	for (Triangle* t : mNavMesh->GetTriangles())
+	for (Vec2& v : mNavMesh->GetVertices())
 	{
-		for (Vec2& v : t->mPoints)
-		{
-			v = Vec2((v.x - (level.GetWidth() * 0.5f)), -(v.y - (level.GetHeight() * 0.5f))) * level.GetCellSize();
-		}
+		v = Vec2((v.x - (level.GetWidth() * 0.5f)), -(v.y - (level.GetHeight() * 0.5f))) * level.GetCellSize();
 	}
 
 	// Construct node graph using the navmesh
 	mNodeGraph = new NodeGraph(mNavMesh);
+	// A handful of landmarks is enough to steer searches around the walls
+	mNodeGraph->BuildLandmarks(8);
+	// Clusters of about 8 by 8 cells
+	mPathHierarchy = new PathHierarchy(mNodeGraph, level.GetCellSize() * 8);
+	mPathScheduler = new PathScheduler(mNodeGraph, &mObstacles);
+	mFlowField = new FlowField(mNodeGraph);
 }
 
 void World::Update(float delta)
@@ -147,17 +153,33 @@ void World::Update(float delta)
 		ImGui::Checkbox("Show single node connections", &bShowSingleNodeConnections);
 		ImGui::Checkbox("Show all node connections", &bShowAllNodeConnections);
 		ImGui::Checkbox("Show agent paths", &bShowAgentPaths);
+		ImGui::Checkbox("Send agents with a flow field", &bUseFlowField);
+		ImGui::Checkbox("Show flow field", &bShowFlowField);
+		if (ImGui::Checkbox("Search long paths on clusters", &bUsePathHierarchy))
+		{
+			mPathScheduler->SetHierarchy(bUsePathHierarchy ? mPathHierarchy : nullptr);
+		}
+		bool redirect = mPathScheduler->GetRedirectUnreachable();
+		if (ImGui::Checkbox("Send agents to the closest reachable point", &redirect)) { mPathScheduler->SetRedirectUnreachable(redirect); }
 		ImGui::SliderInt("Agent Index", &mAgentIndex, 0, mPathAgents.size() - 1);
 
 		if (bShowSingleNodeConnections && mNodeGraph)
 		{
 			bShowAllNodeConnections = false;
-			ImGui::SliderInt("Node Index", &mNodeIndex, 0, mNodeGraph->GetNodeListSize() - 1);
+			ImGui::SliderInt("Node Index", &mNodeIndex, 0, mNodeGraph->GetNodeCount() - 1);
 		}
+
+		PathCache& cache = mPathScheduler->GetPathCache();
+		int capacity = cache.GetCapacity();
+		if (ImGui::SliderInt("Path cache size", &capacity, 0, 4096)) { cache.SetCapacity(capacity); }
+		ImGui::Text("Path cache hits %d misses %d", cache.GetHits(), cache.GetMisses());
 	}
 
 	ImGui::End();
 
+	// Hand back paths finished since the last frame before the agents look for them
+	mPathScheduler->Update();
+
 	for (PathAgent* agents : mPathAgents)
 	{
 		agents->Update(delta);
@@ -186,23 +208,27 @@ void World::Draw(LineRenderer* lines)
 		DrawCircumcircles(lines);
 	}
 
+	if (bShowFlowField)
+	{
+		mFlowField->Draw(lines);
+	}
+
 	if (bShowAllNodeConnections)
 	{
-		for (Node* n : mNodeGraph->GetNodeList())
+		for (int n = 0; n < mNodeGraph->GetNodeCount(); n++)
 		{
-			for (Edge e : n->mConnections)
+			for (int e = mNodeGraph->GetEdgeStart(n); e < mNodeGraph->GetEdgeEnd(n); e++)
 			{
-				lines->DrawLineWithArrow(n->mPosition, e.mTarget->mPosition, Colour::BLUE.Lighten(), 100);
+				lines->DrawLineWithArrow(mNodeGraph->GetPosition(n), mNodeGraph->GetPosition(mNodeGraph->GetEdgeTarget(e)), Colour::BLUE.Lighten(), 100);
 			}
 		}
 	}
 
 	if (bShowSingleNodeConnections)
 	{
-		Node* node = mNodeGraph->GetNodeAt(mNodeIndex);
-		for (Edge e : node->GetConnections())
+		for (int e = mNodeGraph->GetEdgeStart(mNodeIndex); e < mNodeGraph->GetEdgeEnd(mNodeIndex); e++)
 		{
-			lines->DrawLineWithArrow(node->mPosition, e.mTarget->mPosition, Colour::BLUE.Lighten(), 100);
+			lines->DrawLineWithArrow(mNodeGraph->GetPosition(mNodeIndex), mNodeGraph->GetPosition(mNodeGraph->GetEdgeTarget(e)), Colour::BLUE.Lighten(), 100);
 		}
 	}
 }
@@ -322,11 +348,9 @@ Vec2 World::SwitchDirection(int moveDirIdex)
 
 void World::DrawCircumcircles(LineRenderer* lines)
 {
-	Triangle* tri = mNavMesh->GetTriangleAtIndex(mTriangleIndex);
-
-	Vec2 a = tri->mPoints[0];
-	Vec2 b = tri->mPoints[1];
-	Vec2 c = tri->mPoints[2];
+	Vec2 a = mNavMesh->GetTrianglePoint(mTriangleIndex, 0);
+	Vec2 b = mNavMesh->GetTrianglePoint(mTriangleIndex, 1);
+	Vec2 c = mNavMesh->GetTrianglePoint(mTriangleIndex, 2);
 
 	float d = 2 * ((a.x * (b.y - c.y)) + (b.x * (c.y - a.y)) + (c.x * (a.y - b.y)));
 	float x = ((((a.x * a.x) + (a.y * a.y)) * (b.y - c.y)) + ((b.x * b.x + b.y * b.y) * (c.y - a.y)) + (((c.x * c.x) + (c.y * c.y)) * (a.y - b.y))) / d;
@@ -335,9 +359,9 @@ void World::DrawCircumcircles(LineRenderer* lines)
 	Vec2 circumcenter = Vec2{ x,y };
 
 	// Get lengths of each side
-	float ab = (tri->mPoints[1] - tri->mPoints[0]).GetMagnitude();
-	float bc = (tri->mPoints[2] - tri->mPoints[1]).GetMagnitude();
-	float ca = (tri->mPoints[0] - tri->mPoints[2]).GetMagnitude();
+	float ab = (b - a).GetMagnitude();
+	float bc = (c - b).GetMagnitude();
+	float ca = (a - c).GetMagnitude();
 
 	// Triangles half perimeter
 	float s = (ab + bc + ca) * 0.5f;
@@ -356,14 +380,14 @@ void World::DrawCircumcircles(LineRenderer* lines)
 
 
 	Vec2 normals[3];
-	normals[0] = (tri->mEdgeList[0].mPoints[0] - tri->mEdgeList[0].mPoints[1]).GetRotatedBy270().GetNormalised();
-	normals[1] = (tri->mEdgeList[1].mPoints[0] - tri->mEdgeList[1].mPoints[1]).GetRotatedBy270().GetNormalised();
-	normals[2] = (tri->mEdgeList[2].mPoints[0] - tri->mEdgeList[2].mPoints[1]).GetRotatedBy270().GetNormalised();
+	normals[0] = (a - b).GetRotatedBy270().GetNormalised();
+	normals[1] = (b - c).GetRotatedBy270().GetNormalised();
+	normals[2] = (c - a).GetRotatedBy270().GetNormalised();
 
 	Vec2 edgeMidPoints[3];
-	edgeMidPoints[0] = ((tri->mEdgeList[0].mPoints[0] * 1.22f) + tri->mEdgeList[0].mPoints[1]) / 2.22f;
-	edgeMidPoints[1] = ((tri->mEdgeList[1].mPoints[0] * 1.22f) + tri->mEdgeList[1].mPoints[1]) / 2.22f;
-	edgeMidPoints[2] = ((tri->mEdgeList[2].mPoints[0] * 1.22f) + tri->mEdgeList[2].mPoints[1]) / 2.22f;
+	edgeMidPoints[0] = ((a * 1.22f) + b) / 2.22f;
+	edgeMidPoints[1] = ((b * 1.22f) + c) / 2.22f;
+	edgeMidPoints[2] = ((c * 1.22f) + a) / 2.22f;
 
 	for (int i = 0; i < 3; i++)
 	{
@@ -375,6 +399,19 @@ void World::OnLeftClick()
 {
 	if (mPathAgents.empty()) { return; }
 
+	// One search from the goal does for every agent rather than one search each
+	if (bUseFlowField)
+	{
+		mFlowField->Build(cursorPos);
+		if (!mFlowField->IsBuilt()) { return; }
+
+		for (PathAgent* pathagent : mPathAgents)
+		{
+			pathagent->FollowFlowField(mFlowField);
+		}
+		return;
+	}
+
 	for (PathAgent* pathagent : mPathAgents)
 	{
 		pathagent->GoTo(cursorPos);
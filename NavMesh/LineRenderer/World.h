@@ -6,6 +6,9 @@
 #include "PathAgent.h"
 #include "NodeGraph.h"
 #include "NavigationMesh.h"
+#include "PathScheduler.h"
+#include "FlowField.h"
+#include "PathHierarchy.h"
 #include "Vec2.h"
 
 #include <vector>
@@ -24,6 +27,10 @@ class World : public Application
 
 	NodeGraph* mNodeGraph = nullptr;
 	NavigationMesh* mNavMesh = nullptr;
+	PathHierarchy* mPathHierarchy = nullptr;
+	PathScheduler* mPathScheduler = nullptr;
+	// Shared by every agent sent to the same click when bUseFlowField is on
+	FlowField* mFlowField = nullptr;
 	std::vector<Obstacle*> mObstacles;
 	std::vector<PathAgent*> mPathAgents;
 
@@ -32,6 +39,9 @@ class World : public Application
 	bool bShowSingleNodeConnections;
 	bool bShowAllNodeConnections;
 	bool bShowAgentPaths;
+	bool bUseFlowField = false;
+	bool bShowFlowField = false;
+	bool bUsePathHierarchy = false;
 	int mNodeIndex = 0;
 	int mTriangleIndex = 0;
 	int mAgentIndex = 0;
@@ -50,6 +60,8 @@ public:
 	std::vector<Vec2> LineTrace(Vec2 startPos, Grid& grid, TileType tileType);
 	Vec2 SwitchDirection(int moveDirIdex);
 	std::vector<Obstacle*>& GetObstacles() { return mObstacles; }
+	NavigationMesh* GetNavMesh() { return mNavMesh; }
+	PathScheduler* GetPathScheduler() { return mPathScheduler; }
 
 	void DrawCircumcircles(LineRenderer* lines);
 };